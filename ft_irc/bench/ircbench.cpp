@@ -0,0 +1,605 @@
+// Load generator for ircserv. Connects simulated clients over loopback, runs
+// the full PASS/NICK/USER registration and initial JOINs, then drives a
+// JOIN/PART/PRIVMSG mix at a fixed rate. Every PRIVMSG carries its send time
+// so receivers measure end-to-end delivery latency. Results are printed as
+// one JSON object, optionally appended to a file.
+//
+// Clients are spread over 127.1.x.y source addresses so the server's per-IP
+// admission limit applies as it would to real users.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define READ_CHUNK 65536
+#define CONNECT_BATCH 128
+#define SETUP_TIMEOUT 60.0
+#define DRAIN_TIMEOUT 3.0
+#define DRAIN_QUIET 0.3
+
+struct Options {
+    std::string host;
+    int port;
+    std::string password;
+    std::string label;
+    std::string output;
+    int clients;
+    int channels;
+    int joins;
+    int perAddress;
+    int payload;
+    double duration;
+    double rate;
+    int privmsgWeight;
+    int joinWeight;
+    int partWeight;
+    int serverPid;
+};
+
+struct BenchClient {
+    int fd;
+    std::string input;
+    std::string output;
+    bool watchingWrite;
+    bool registered;
+    int pendingJoins;
+    std::vector<int> channels;
+};
+
+struct ProcessSample {
+    double cpuSeconds;
+    long rssKb;
+    long peakRssKb;
+};
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t nowMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Server process accounting from /proc; zeros when no pid was given
+static ProcessSample sampleProcess(int pid) {
+    ProcessSample sample = { 0.0, 0, 0 };
+    if (pid <= 0)
+        return sample;
+
+    std::ostringstream path;
+    path << "/proc/" << pid << "/stat";
+    std::ifstream stat(path.str().c_str());
+    std::string line;
+    if (std::getline(stat, line)) {
+        // Fields after the parenthesized command name; utime and stime are 14 and 15
+        std::istringstream fields(line.substr(line.rfind(')') + 2));
+        std::string field;
+        unsigned long utime = 0, stime = 0;
+        for (int i = 3; i <= 15 && fields >> field; ++i) {
+            if (i == 14)
+                utime = std::strtoul(field.c_str(), NULL, 10);
+            else if (i == 15)
+                stime = std::strtoul(field.c_str(), NULL, 10);
+        }
+        sample.cpuSeconds = static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+    }
+
+    std::ostringstream statusPath;
+    statusPath << "/proc/" << pid << "/status";
+    std::ifstream status(statusPath.str().c_str());
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            sample.rssKb = std::atol(line.c_str() + 6);
+        else if (line.compare(0, 6, "VmHWM:") == 0)
+            sample.peakRssKb = std::atol(line.c_str() + 6);
+    }
+    return sample;
+}
+
+class LoadGenerator {
+private:
+    Options _options;
+    int _epoll;
+    std::vector<BenchClient> _clients;
+    std::vector<int> _channelSizes;
+    std::vector<unsigned int> _latencies;
+    uint32_t _random;
+    size_t _registered;
+    size_t _pendingJoins;
+    size_t _disconnected;
+    size_t _rejected;
+    size_t _sent;
+    size_t _joinsSent;
+    size_t _partsSent;
+    size_t _delivered;
+    size_t _expected;
+    double _lastDelivery;
+    std::string _padding;
+
+    LoadGenerator(const LoadGenerator& other);
+    LoadGenerator& operator=(const LoadGenerator& other);
+
+    uint32_t nextRandom() {
+        // xorshift32; the generator only needs to be cheap and repeatable
+        _random ^= _random << 13;
+        _random ^= _random >> 17;
+        _random ^= _random << 5;
+        return _random;
+    }
+
+    static std::string channelName(int channel) {
+        std::ostringstream name;
+        name << "#bench" << channel;
+        return name.str();
+    }
+
+    void watch(size_t index, bool write) {
+        BenchClient& client = _clients[index];
+        struct epoll_event event;
+        event.events = write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.u64 = index;
+        epoll_ctl(_epoll, EPOLL_CTL_MOD, client.fd, &event);
+        client.watchingWrite = write;
+    }
+
+    void send(size_t index, const std::string& data) {
+        BenchClient& client = _clients[index];
+        if (client.fd == -1)
+            return;
+        client.output += data;
+        if (!client.watchingWrite)
+            flush(index);
+    }
+
+    void flush(size_t index) {
+        BenchClient& client = _clients[index];
+        while (!client.output.empty()) {
+            ssize_t written = ::send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+            if (written > 0) {
+                client.output.erase(0, written);
+                continue;
+            }
+            if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!client.watchingWrite)
+                    watch(index, true);
+                return;
+            }
+            if (written == -1 && errno == EINTR)
+                continue;
+            disconnect(index);
+            return;
+        }
+        if (client.watchingWrite)
+            watch(index, false);
+    }
+
+    void disconnect(size_t index) {
+        BenchClient& client = _clients[index];
+        if (client.fd == -1)
+            return;
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, client.fd, NULL);
+        close(client.fd);
+        client.fd = -1;
+        if (!client.registered)
+            ++_rejected;
+        else
+            ++_disconnected;
+        _pendingJoins -= client.pendingJoins;
+        client.pendingJoins = 0;
+    }
+
+    void handleLine(size_t index, const char* line, size_t length) {
+        BenchClient& client = _clients[index];
+
+        // ":t=<micros>" marks a timed PRIVMSG
+        const char* stamp = static_cast<const char*>(memmem(line, length, " :t=", 4));
+        if (stamp) {
+            uint64_t sentAt = std::strtoull(stamp + 4, NULL, 10);
+            uint64_t current = nowMicros();
+            _latencies.push_back(static_cast<unsigned int>(current > sentAt ? current - sentAt : 0));
+            ++_delivered;
+            _lastDelivery = now();
+            return;
+        }
+
+        // Numerics: ":server NNN ..."
+        const char* space = static_cast<const char*>(memchr(line, ' ', length));
+        if (!space || line + length - space < 4)
+            return;
+        if (std::memcmp(space + 1, "001", 3) == 0 && !client.registered) {
+            client.registered = true;
+            ++_registered;
+        } else if (std::memcmp(space + 1, "366", 3) == 0 && client.pendingJoins > 0) {
+            --client.pendingJoins;
+            --_pendingJoins;
+        }
+    }
+
+    void handleRead(size_t index) {
+        char buffer[READ_CHUNK];
+        BenchClient& client = _clients[index];
+
+        for (;;) {
+            ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                client.input.append(buffer, received);
+                continue;
+            }
+            if (received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (received == -1 && errno == EINTR)
+                continue;
+            disconnect(index);
+            return;
+        }
+
+        size_t start = 0;
+        size_t end;
+        while ((end = client.input.find("\r\n", start)) != std::string::npos) {
+            handleLine(index, client.input.data() + start, end - start);
+            start = end + 2;
+        }
+        client.input.erase(0, start);
+    }
+
+    void pump(int timeoutMs) {
+        struct epoll_event events[256];
+        int ready = epoll_wait(_epoll, events, 256, timeoutMs);
+        for (int i = 0; i < ready; ++i) {
+            size_t index = events[i].data.u64;
+            if (_clients[index].fd == -1)
+                continue;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                handleRead(index);
+            if (_clients[index].fd != -1 && (events[i].events & EPOLLOUT))
+                flush(index);
+        }
+    }
+
+    bool connectClient(size_t index) {
+        BenchClient& client = _clients[index];
+        client.fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (client.fd == -1)
+            return false;
+
+        int one = 1;
+        setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        struct sockaddr_in local;
+        std::memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl((127u << 24) | (1u << 16) | ((index / _options.perAddress) & 0xffff));
+        if (bind(client.fd, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) == -1) {
+            close(client.fd);
+            client.fd = -1;
+            return false;
+        }
+
+        struct sockaddr_in remote;
+        std::memset(&remote, 0, sizeof(remote));
+        remote.sin_family = AF_INET;
+        remote.sin_port = htons(_options.port);
+        inet_pton(AF_INET, _options.host.c_str(), &remote.sin_addr);
+        if (connect(client.fd, reinterpret_cast<struct sockaddr*>(&remote), sizeof(remote)) == -1) {
+            close(client.fd);
+            client.fd = -1;
+            return false;
+        }
+        fcntl(client.fd, F_SETFL, O_NONBLOCK);
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = index;
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, client.fd, &event);
+        client.watchingWrite = false;
+
+        // Registration and the initial joins go out in one write
+        std::ostringstream burst;
+        burst << "PASS " << _options.password << "\r\n"
+              << "NICK b" << index << "\r\n"
+              << "USER b" << index << " 0 * :ircbench\r\n";
+        for (int j = 0; j < _options.joins; ++j) {
+            int channel = static_cast<int>((index * _options.joins + j) % _options.channels);
+            if (std::find(client.channels.begin(), client.channels.end(), channel) != client.channels.end())
+                continue;
+            client.channels.push_back(channel);
+            ++_channelSizes[channel];
+            burst << "JOIN " << channelName(channel) << "\r\n";
+            ++client.pendingJoins;
+            ++_pendingJoins;
+        }
+        send(index, burst.str());
+        return true;
+    }
+
+    void sendPrivmsg(size_t index) {
+        BenchClient& client = _clients[index];
+        if (client.channels.empty())
+            return;
+        int channel = client.channels[nextRandom() % client.channels.size()];
+
+        char header[96];
+        int length = std::snprintf(header, sizeof(header), "PRIVMSG #bench%d :t=%llu ", channel,
+                                   static_cast<unsigned long long>(nowMicros()));
+        std::string line(header, length);
+        line += _padding;
+        line += "\r\n";
+        send(index, line);
+        ++_sent;
+        _expected += _channelSizes[channel] - 1;
+    }
+
+    void sendJoin(size_t index) {
+        BenchClient& client = _clients[index];
+        if (static_cast<int>(client.channels.size()) >= _options.channels)
+            return;
+        int channel;
+        do {
+            channel = nextRandom() % _options.channels;
+        } while (std::find(client.channels.begin(), client.channels.end(), channel) != client.channels.end());
+
+        client.channels.push_back(channel);
+        ++_channelSizes[channel];
+        send(index, "JOIN " + channelName(channel) + "\r\n");
+        ++_joinsSent;
+    }
+
+    void sendPart(size_t index) {
+        // Every client keeps at least one channel so it still sees traffic
+        BenchClient& client = _clients[index];
+        if (client.channels.size() < 2)
+            return;
+        size_t slot = nextRandom() % client.channels.size();
+        int channel = client.channels[slot];
+        client.channels[slot] = client.channels.back();
+        client.channels.pop_back();
+        --_channelSizes[channel];
+        send(index, "PART " + channelName(channel) + "\r\n");
+        ++_partsSent;
+    }
+
+    void issueOperation() {
+        size_t index = nextRandom() % _clients.size();
+        if (_clients[index].fd == -1)
+            return;
+
+        int total = _options.privmsgWeight + _options.joinWeight + _options.partWeight;
+        int pick = nextRandom() % total;
+        if (pick < _options.privmsgWeight)
+            sendPrivmsg(index);
+        else if (pick < _options.privmsgWeight + _options.joinWeight)
+            sendJoin(index);
+        else
+            sendPart(index);
+    }
+
+    unsigned int percentile(double fraction) const {
+        if (_latencies.empty())
+            return 0;
+        size_t rank = static_cast<size_t>(fraction * (_latencies.size() - 1));
+        return _latencies[rank];
+    }
+
+public:
+    LoadGenerator(const Options& options)
+        : _options(options), _epoll(epoll_create1(EPOLL_CLOEXEC)), _random(2463534242u),
+          _registered(0), _pendingJoins(0), _disconnected(0), _rejected(0), _sent(0),
+          _joinsSent(0), _partsSent(0), _delivered(0), _expected(0), _lastDelivery(0.0),
+          _padding(options.payload, 'x') {
+        BenchClient blank;
+        blank.fd = -1;
+        blank.watchingWrite = false;
+        blank.registered = false;
+        blank.pendingJoins = 0;
+        _clients.resize(options.clients, blank);
+        _channelSizes.resize(options.channels, 0);
+    }
+
+    ~LoadGenerator() {
+        for (size_t i = 0; i < _clients.size(); ++i) {
+            if (_clients[i].fd != -1)
+                close(_clients[i].fd);
+        }
+        close(_epoll);
+    }
+
+    int run() {
+        // Setup: connect in batches, reading replies in between so the
+        // server never stalls on our receive buffers
+        double setupStart = now();
+        size_t connectFailures = 0;
+        for (size_t i = 0; i < _clients.size(); ++i) {
+            if (!connectClient(i))
+                ++connectFailures;
+            if (i % CONNECT_BATCH == CONNECT_BATCH - 1)
+                pump(0);
+        }
+        while ((_registered + _rejected + connectFailures < _clients.size() || _pendingJoins > 0)
+               && now() - setupStart < SETUP_TIMEOUT)
+            pump(10);
+        double setupTime = now() - setupStart;
+
+        // Measured phase: operations are paced against the wall clock
+        ProcessSample before = sampleProcess(_options.serverPid);
+        _latencies.clear();
+        _delivered = 0;
+        double start = now();
+        double elapsed = 0.0;
+        size_t issued = 0;
+        while ((elapsed = now() - start) < _options.duration) {
+            size_t target = static_cast<size_t>(elapsed * _options.rate);
+            while (issued < target) {
+                issueOperation();
+                ++issued;
+            }
+            pump(1);
+        }
+        double sendTime = now() - start;
+
+        // Drain whatever is still in flight
+        _lastDelivery = now();
+        while (now() - _lastDelivery < DRAIN_QUIET && now() - start < _options.duration + DRAIN_TIMEOUT)
+            pump(10);
+        double totalTime = now() - start;
+        ProcessSample after = sampleProcess(_options.serverPid);
+
+        std::sort(_latencies.begin(), _latencies.end());
+        double cpu = after.cpuSeconds - before.cpuSeconds;
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed);
+        json.precision(1);
+        json << "{\"label\":\"" << _options.label << "\""
+             << ",\"clients\":" << _options.clients
+             << ",\"registered\":" << _registered
+             << ",\"rejected\":" << (_rejected + connectFailures)
+             << ",\"disconnected\":" << _disconnected
+             << ",\"channels\":" << _options.channels
+             << ",\"joins_per_client\":" << _options.joins
+             << ",\"setup_seconds\":" << setupTime
+             << ",\"duration_seconds\":" << sendTime
+             << ",\"privmsg_sent\":" << _sent
+             << ",\"joins_sent\":" << _joinsSent
+             << ",\"parts_sent\":" << _partsSent
+             << ",\"deliveries_expected\":" << _expected
+             << ",\"deliveries\":" << _delivered
+             << ",\"sent_per_second\":" << _sent / sendTime
+             << ",\"delivered_per_second\":" << _delivered / totalTime
+             << ",\"latency_us\":{\"p50\":" << percentile(0.50)
+             << ",\"p99\":" << percentile(0.99)
+             << ",\"p999\":" << percentile(0.999)
+             << ",\"max\":" << percentile(1.0) << "}"
+             << ",\"server_cpu_percent\":" << (totalTime > 0 ? 100.0 * cpu / totalTime : 0.0)
+             << ",\"server_rss_kb\":" << after.rssKb
+             << ",\"server_peak_rss_kb\":" << after.peakRssKb
+             << "}";
+
+        std::cout << json.str() << std::endl;
+        if (!_options.output.empty()) {
+            std::ofstream out(_options.output.c_str(), std::ios::app);
+            out << json.str() << std::endl;
+        }
+        return _registered == _clients.size() ? 0 : 1;
+    }
+};
+
+static void usage(const char* name) {
+    std::cerr << "Usage: " << name << " [options]\n"
+              << "  --host ADDR         server address (127.0.0.1)\n"
+              << "  --port N            server port (6667)\n"
+              << "  --password PASS     connection password (bench)\n"
+              << "  --clients N         simulated clients (1000)\n"
+              << "  --channels N        channels to spread them over (100)\n"
+              << "  --joins N           channels joined per client at start (1)\n"
+              << "  --per-address N     clients per 127.1.x.y source address (32)\n"
+              << "  --duration SECONDS  measured phase length (10)\n"
+              << "  --rate N            operations per second across all clients (1000)\n"
+              << "  --mix P,J,L         PRIVMSG, JOIN and PART weights (100,0,0)\n"
+              << "  --payload BYTES     PRIVMSG text padding (64)\n"
+              << "  --server-pid PID    sample this process's CPU and RSS\n"
+              << "  --label NAME        scenario name in the results\n"
+              << "  --output FILE       append the JSON result to FILE\n";
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+
+        if (option == "--host")
+            options.host = value;
+        else if (option == "--port")
+            options.port = std::atoi(value.c_str());
+        else if (option == "--password")
+            options.password = value;
+        else if (option == "--clients")
+            options.clients = std::atoi(value.c_str());
+        else if (option == "--channels")
+            options.channels = std::atoi(value.c_str());
+        else if (option == "--joins")
+            options.joins = std::atoi(value.c_str());
+        else if (option == "--per-address")
+            options.perAddress = std::atoi(value.c_str());
+        else if (option == "--duration")
+            options.duration = std::atof(value.c_str());
+        else if (option == "--rate")
+            options.rate = std::atof(value.c_str());
+        else if (option == "--payload")
+            options.payload = std::atoi(value.c_str());
+        else if (option == "--server-pid")
+            options.serverPid = std::atoi(value.c_str());
+        else if (option == "--label")
+            options.label = value;
+        else if (option == "--output")
+            options.output = value;
+        else if (option == "--mix") {
+            if (std::sscanf(value.c_str(), "%d,%d,%d", &options.privmsgWeight,
+                            &options.joinWeight, &options.partWeight) != 3)
+                return false;
+        } else
+            return false;
+    }
+    return options.port > 0 && options.clients > 0 && options.channels > 0 && options.joins > 0
+        && options.perAddress > 0 && options.duration > 0 && options.rate > 0 && options.payload >= 0
+        && options.privmsgWeight >= 0 && options.joinWeight >= 0 && options.partWeight >= 0
+        && options.privmsgWeight + options.joinWeight + options.partWeight > 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.host = "127.0.0.1";
+    options.port = 6667;
+    options.password = "bench";
+    options.label = "custom";
+    options.clients = 1000;
+    options.channels = 100;
+    options.joins = 1;
+    options.perAddress = 32;
+    options.payload = 64;
+    options.duration = 10.0;
+    options.rate = 1000.0;
+    options.privmsgWeight = 100;
+    options.joinWeight = 0;
+    options.partWeight = 0;
+    options.serverPid = 0;
+
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Tens of thousands of sockets need the hard descriptor limit
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    LoadGenerator generator(options);
+    return generator.run();
+}
@@ -0,0 +1,435 @@
+// Per-component benchmarks for the server's hot paths: line framing,
+// parsing, command dispatch, target splitting, name validation and channel
+// fan-out. Each benchmark runs over a fixed corpus of IRC traffic and is
+// repeated with a growing iteration count until it takes long enough to
+// time; results are reported as ns/op, allocations/op and bytes/op.
+// Allocations are counted by replacing the global operator new, so only
+// the measured sections are charged; pool-backed objects do not count.
+//
+// No socket is ever written: broadcast targets have no reactor, and the
+// dispatch client's reactor is never run, so output simply accumulates in
+// OutputQueues that are emptied between batches.
+
+#include "../include/Server.hpp"
+#include "../include/Client.hpp"
+#include "../include/Channel.hpp"
+#include "../include/Command.hpp"
+#include "../include/Message.hpp"
+#include "../include/InputBuffer.hpp"
+#include "../include/SharedBuffer.hpp"
+#include "../include/Arena.hpp"
+#include "../include/Utils.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#define MIN_BENCH_SECONDS 0.2
+#define MAX_ITERATIONS 100000000
+#define DISPATCH_BATCH 256
+#define BROADCAST_BATCH 64
+#define BUFFER_BATCH 256
+#define FAKE_FD_BASE 1000000
+
+// Allocation accounting
+static size_t g_allocations = 0;
+static size_t g_allocatedBytes = 0;
+
+void* operator new(std::size_t size) throw(std::bad_alloc) {
+    ++g_allocations;
+    g_allocatedBytes += size;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](std::size_t size) throw(std::bad_alloc) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) throw() {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) throw() {
+    std::free(memory);
+}
+
+// Fixed corpora
+static const char* TRAFFIC[] = {
+    "PRIVMSG #linux :has anyone tried the 6.8 kernel on arm64 yet?",
+    ":alice!alice@203.0.113.7 PRIVMSG #linux :yes, boots fine on my pinebook",
+    "@time=2024-05-01T12:00:00.000Z;msgid=8f2c :bob!b@198.51.100.2 PRIVMSG #dev :tagged line",
+    "PING :irc.example.net",
+    "PONG :irc.example.net",
+    "JOIN #a,#b,#c key1,key2",
+    "MODE #linux +o alice",
+    "NICK carol_",
+    "USER guest 0 * :Guest User",
+    "NOTICE bob :are you around?",
+    "PART #linux :see you tomorrow",
+    "TOPIC #dev :release freeze starts friday",
+    "KICK #dev mallory :spam",
+    "PRIVMSG alice,bob,#dev :multi target hello",
+    "PRIVMSG #dev :a longer message with quite a bit more text in it, the kind people paste "
+        "when they are explaining something and keep typing well past the usual length",
+    "QUIT :Leaving"
+};
+
+// What one registered client sends in steady state
+static const char* DISPATCH[] = {
+    "PRIVMSG #bench :hello everyone, how is it going?",
+    "PRIVMSG peer :direct message",
+    "NOTICE #bench :notice to the channel",
+    "PING :irc.example.net",
+    "PONG :irc.example.net",
+    "PRIVMSG #bench,peer :two targets at once",
+    "MODE #bench",
+    "TOPIC #bench",
+    "FOO unknown command"
+};
+
+static const char* TARGETS[] = {
+    "#linux",
+    "alice,bob",
+    "#a,#b,#c,#d",
+    "alice, #dev ,bob,,#ops"
+};
+
+static const char* NICKNAMES[] = {
+    "alice", "Bob_", "[guest]", "x", "carol^away", "9invalid", "way_too_long_nickname", "d-e-f", ""
+};
+
+static const char* CHANNELS[] = {
+    "#linux", "&local", "#a", "nochannelprefix", "#with space", "#with,comma", "#", "#really_long_but_fine"
+};
+
+#define COUNT(array) (sizeof(array) / sizeof(array[0]))
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Timing and allocation totals for the measured sections of one run
+class BenchState {
+private:
+    double _elapsed;
+    double _startedAt;
+    size_t _allocations;
+    size_t _bytes;
+    size_t _startAllocations;
+    size_t _startBytes;
+
+public:
+    BenchState() : _elapsed(0), _startedAt(0), _allocations(0), _bytes(0), _startAllocations(0), _startBytes(0) {}
+
+    void start() {
+        _startAllocations = g_allocations;
+        _startBytes = g_allocatedBytes;
+        _startedAt = now();
+    }
+
+    void stop() {
+        _elapsed += now() - _startedAt;
+        _allocations += g_allocations - _startAllocations;
+        _bytes += g_allocatedBytes - _startBytes;
+    }
+
+    double elapsed() const { return _elapsed; }
+    size_t allocations() const { return _allocations; }
+    size_t bytes() const { return _bytes; }
+};
+
+// A reactor that never runs: its thread binding makes sends to its clients
+// queue locally, and endIteration() stands in for the loop's bookkeeping
+class BenchReactor : public Reactor {
+public:
+    BenchReactor(Server* server) : Reactor(server, 0, Poller::create(Poller::BACKEND_POLL)) {
+        bindToCurrentThread();
+    }
+
+    void endIteration() {
+        _pendingWrites.clear();
+        _arena.reset();
+    }
+};
+
+static Client* stubClient(int index, Reactor* reactor) {
+    // Distinct fake fds keep channel membership apart; none is ever used for I/O
+    in_addr_t address = htonl((10u << 24) | (index & 0xffffff));
+    return new Client(FAKE_FD_BASE + index, reactor, address);
+}
+
+static std::vector<StringView> corpusViews(const char** lines, size_t count) {
+    std::vector<StringView> views;
+    for (size_t i = 0; i < count; ++i)
+        views.push_back(StringView::from(lines[i]));
+    return views;
+}
+
+// Benchmarks
+static void benchFraming(BenchState& state, size_t iterations) {
+    std::string stream;
+    for (size_t i = 0; i < COUNT(TRAFFIC); ++i)
+        stream.append(TRAFFIC[i]).append("\r\n");
+
+    InputBuffer* input = new InputBuffer;
+    StringView line;
+    size_t done = 0;
+    state.start();
+    while (done < iterations) {
+        input->append(stream.data(), stream.length());
+        while (done < iterations && input->next(line) == InputBuffer::LINE_READY)
+            ++done;
+    }
+    state.stop();
+    delete input;
+}
+
+static void benchParsing(BenchState& state, size_t iterations) {
+    std::vector<StringView> lines = corpusViews(TRAFFIC, COUNT(TRAFFIC));
+    Message message;
+    size_t commands = 0;
+    state.start();
+    for (size_t i = 0; i < iterations; ++i)
+        commands += message.parse(lines[i % lines.size()]);
+    state.stop();
+    if (commands == 0)
+        std::cerr << "no commands parsed" << std::endl;
+}
+
+static void benchLookup(BenchState& state, size_t iterations) {
+    std::vector<StringView> verbs;
+    Message message;
+    for (size_t i = 0; i < COUNT(TRAFFIC); ++i) {
+        message.parse(StringView::from(TRAFFIC[i]));
+        verbs.push_back(message.getCommand());
+    }
+    size_t found = 0;
+    state.start();
+    for (size_t i = 0; i < iterations; ++i)
+        found += Command::lookup(verbs[i % verbs.size()]) != NULL;
+    state.stop();
+    if (found == 0)
+        std::cerr << "no commands found" << std::endl;
+}
+
+static void benchDispatch(BenchState& state, size_t iterations) {
+    Server server(0, "bench", Poller::BACKEND_POLL, 1);
+    BenchReactor reactor(&server);
+
+    Client* sender = stubClient(0, &reactor);
+    Client* peer = stubClient(1, NULL);
+    server.setNickname(sender, "sender");
+    server.setNickname(peer, "peer");
+    sender->setRegistered(true);
+    peer->setRegistered(true);
+
+    Channel* channel = server.createChannel("#bench");
+    std::vector<Client*> members;
+    channel->addClient(sender);
+    channel->addOperator(sender);
+    for (int i = 0; i < 9; ++i) {
+        members.push_back(stubClient(2 + i, NULL));
+        channel->addClient(members.back());
+    }
+    members.push_back(peer);
+    members.push_back(sender);
+
+    // The first batch is untimed: it sizes the arena and the output rings
+    std::vector<StringView> lines = corpusViews(DISPATCH, COUNT(DISPATCH));
+    BenchState warmup;
+    for (size_t done = 0; done < iterations; ) {
+        size_t batch = std::min(static_cast<size_t>(DISPATCH_BATCH), iterations - done);
+        BenchState& measured = warmup.elapsed() > 0 ? state : warmup;
+        measured.start();
+        for (size_t i = 0; i < batch; ++i)
+            server.processCommand(sender, lines[(done + i) % lines.size()]);
+        measured.stop();
+        if (&measured == &state)
+            done += batch;
+
+        for (size_t i = 0; i < members.size(); ++i)
+            members[i]->getOutputQueue().clear();
+        reactor.endIteration();
+    }
+
+    server.detachClient(sender);
+    for (size_t i = 0; i < members.size(); ++i) {
+        if (members[i] != sender)
+            server.detachClient(members[i]);
+        delete members[i];
+    }
+}
+
+static void benchSplitString(BenchState& state, size_t iterations) {
+    std::vector<std::string> lists(TARGETS, TARGETS + COUNT(TARGETS));
+    size_t tokens = 0;
+    state.start();
+    for (size_t i = 0; i < iterations; ++i)
+        tokens += Utils::split(lists[i % lists.size()], ',').size();
+    state.stop();
+    if (tokens == 0)
+        std::cerr << "no tokens" << std::endl;
+}
+
+static void benchSplitArena(BenchState& state, size_t iterations) {
+    std::vector<StringView> lists = corpusViews(TARGETS, COUNT(TARGETS));
+    Arena arena;
+    size_t tokens = 0;
+    state.start();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t count;
+        Utils::split(arena, lists[i % lists.size()], ',', count);
+        tokens += count;
+        if (i % 1024 == 1023)
+            arena.reset();
+    }
+    state.stop();
+    if (tokens == 0)
+        std::cerr << "no tokens" << std::endl;
+}
+
+static void benchNicknames(BenchState& state, size_t iterations) {
+    std::vector<std::string> names(NICKNAMES, NICKNAMES + COUNT(NICKNAMES));
+    size_t valid = 0;
+    state.start();
+    for (size_t i = 0; i < iterations; ++i)
+        valid += Utils::isValidNickname(names[i % names.size()]);
+    state.stop();
+    if (valid == 0)
+        std::cerr << "no valid nicknames" << std::endl;
+}
+
+static void benchChannelNames(BenchState& state, size_t iterations) {
+    std::vector<std::string> names(CHANNELS, CHANNELS + COUNT(CHANNELS));
+    size_t valid = 0;
+    state.start();
+    for (size_t i = 0; i < iterations; ++i)
+        valid += Utils::isValidChannelName(names[i % names.size()]);
+    state.stop();
+    if (valid == 0)
+        std::cerr << "no valid channel names" << std::endl;
+}
+
+static void benchBroadcast(BenchState& state, size_t iterations, int size) {
+    Channel* channel = new Channel("#fanout");
+    std::vector<Client*> members;
+    for (int i = 0; i < size; ++i) {
+        members.push_back(stubClient(i, NULL));
+        channel->addClient(members.back());
+    }
+
+    // The first batch is untimed: it sizes every member's output ring
+    StringView line = StringView::from(":alice!alice@203.0.113.7 PRIVMSG #fanout :hello everyone\r\n");
+    BenchState warmup;
+    for (size_t done = 0; done < iterations; ) {
+        size_t batch = std::min(static_cast<size_t>(BROADCAST_BATCH), iterations - done);
+        BenchState& measured = warmup.elapsed() > 0 ? state : warmup;
+        measured.start();
+        for (size_t i = 0; i < batch; ++i)
+            channel->broadcast(line, members[0]);
+        measured.stop();
+        if (&measured == &state)
+            done += batch;
+
+        for (size_t i = 0; i < members.size(); ++i)
+            members[i]->getOutputQueue().clear();
+    }
+
+    delete channel;
+    for (size_t i = 0; i < members.size(); ++i)
+        delete members[i];
+}
+
+// Held in flight like output queues do, so releases refill the cache
+static void benchBuffers(BenchState& state, size_t iterations) {
+    StringView line = StringView::from(":alice!alice@203.0.113.7 PRIVMSG #fanout :hello everyone\r\n");
+    const SharedBuffer* held[BUFFER_BATCH];
+    state.start();
+    for (size_t done = 0; done < iterations; ) {
+        size_t batch = std::min(static_cast<size_t>(BUFFER_BATCH), iterations - done);
+        for (size_t i = 0; i < batch; ++i)
+            held[i] = SharedBuffer::create(line);
+        for (size_t i = 0; i < batch; ++i)
+            held[i]->release();
+        done += batch;
+    }
+    state.stop();
+}
+
+static void benchBroadcast10(BenchState& state, size_t iterations) {
+    benchBroadcast(state, iterations, 10);
+}
+
+static void benchBroadcast1000(BenchState& state, size_t iterations) {
+    benchBroadcast(state, iterations, 1000);
+}
+
+static void benchBroadcast50000(BenchState& state, size_t iterations) {
+    benchBroadcast(state, iterations, 50000);
+}
+
+// Driver
+struct Benchmark {
+    const char* name;
+    void (*run)(BenchState& state, size_t iterations);
+};
+
+static const Benchmark BENCHMARKS[] = {
+    { "frame/InputBuffer::next",          benchFraming },
+    { "parse/Message::parse",             benchParsing },
+    { "dispatch/Command::lookup",         benchLookup },
+    { "dispatch/Command::execute",        benchDispatch },
+    { "split/Utils::split(string)",       benchSplitString },
+    { "split/Utils::split(arena)",        benchSplitArena },
+    { "validate/isValidNickname",         benchNicknames },
+    { "validate/isValidChannelName",      benchChannelNames },
+    { "buffer/SharedBuffer::create",      benchBuffers },
+    { "broadcast/10",                     benchBroadcast10 },
+    { "broadcast/1000",                   benchBroadcast1000 },
+    { "broadcast/50000",                  benchBroadcast50000 }
+};
+
+int main(int argc, char* argv[]) {
+    const char* filter = argc > 1 ? argv[1] : NULL;
+
+    std::cout << std::left << std::setw(34) << "benchmark" << std::right
+              << std::setw(12) << "ops" << std::setw(14) << "ns/op"
+              << std::setw(12) << "allocs/op" << std::setw(12) << "bytes/op" << std::endl;
+
+    for (size_t b = 0; b < COUNT(BENCHMARKS); ++b) {
+        const Benchmark& bench = BENCHMARKS[b];
+        if (filter && !std::strstr(bench.name, filter))
+            continue;
+
+        // Grow the iteration count until one run is long enough to time
+        size_t iterations = 1;
+        BenchState state;
+        for (;;) {
+            state = BenchState();
+            bench.run(state, iterations);
+            if (state.elapsed() >= MIN_BENCH_SECONDS || iterations >= MAX_ITERATIONS)
+                break;
+            double scale = state.elapsed() > 0 ? 1.2 * MIN_BENCH_SECONDS / state.elapsed() : 100.0;
+            size_t next = static_cast<size_t>(iterations * std::min(100.0, std::max(2.0, scale)));
+            iterations = std::min(next, static_cast<size_t>(MAX_ITERATIONS));
+        }
+
+        std::cout << std::left << std::setw(34) << bench.name << std::right << std::fixed
+                  << std::setw(12) << iterations
+                  << std::setw(14) << std::setprecision(1) << state.elapsed() * 1e9 / iterations
+                  << std::setw(12) << std::setprecision(2) << static_cast<double>(state.allocations()) / iterations
+                  << std::setw(12) << std::setprecision(1) << static_cast<double>(state.bytes()) / iterations
+                  << std::endl;
+    }
+    return 0;
+}
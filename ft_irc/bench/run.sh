@@ -0,0 +1,63 @@
+#!/bin/sh
+# Standard load scenarios for `make bench`. Each scenario gets a fresh
+# ircserv; ircbench appends one JSON object per scenario to $RESULTS.
+#
+#   RESULTS      output file (bench/results.jsonl)
+#   BENCH_PORT   port for the server under test (16667)
+#   SERVER_ARGS  extra ircserv options, e.g. "--backend io_uring --threads 2"
+#   START_TIMEOUT  seconds to wait for the server to listen (10)
+
+cd "$(dirname "$0")/.." || exit 1
+
+SERVER=./ircserv
+BENCH=./ircbench
+PORT=${BENCH_PORT:-16667}
+RESULTS=${RESULTS:-bench/results.jsonl}
+START_TIMEOUT=${START_TIMEOUT:-10}
+LOG=${TMPDIR:-/tmp}/ircserv-bench.$$
+STATUS=0
+
+trap 'rm -f "$LOG"' EXIT
+
+# Both sides hold one descriptor per simulated client
+ulimit -n "$(ulimit -Hn)" 2>/dev/null
+
+: > "$RESULTS"
+
+# ircserv prints its start line only once every listener accepts
+# connections; give up if it exits first or START_TIMEOUT runs out
+wait_for_server() {
+    tries=0
+    until grep -q "^Server started" "$LOG" 2> /dev/null; do
+        kill -0 "$pid" 2> /dev/null || return 1
+        tries=$((tries + 1))
+        [ "$tries" -gt $((START_TIMEOUT * 10)) ] && return 1
+        sleep 0.1
+    done
+}
+
+scenario() {
+    label=$1
+    shift
+    $SERVER "$PORT" bench --max-clients 100000 $SERVER_ARGS > "$LOG" &
+    pid=$!
+    if ! wait_for_server; then
+        echo "$label: server did not start listening on port $PORT" >&2
+        cat "$LOG" >&2
+        kill "$pid" 2> /dev/null
+        wait "$pid" 2> /dev/null
+        STATUS=1
+        return
+    fi
+    $BENCH --port "$PORT" --password bench --server-pid "$pid" --label "$label" --output "$RESULTS" "$@" || STATUS=1
+    kill "$pid"
+    wait "$pid" 2> /dev/null
+}
+
+scenario small-channels --clients 2000 --channels 200 --rate 5000
+scenario large-channel --clients 1000 --channels 1 --rate 200
+scenario join-part-mix --clients 2000 --channels 100 --joins 2 --mix 80,10,10 --rate 2000
+scenario many-clients --clients 10000 --channels 1000 --rate 2000
+
+echo "Results written to $RESULTS"
+exit $STATUS
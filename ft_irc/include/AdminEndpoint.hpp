@@ -0,0 +1,70 @@
+#ifndef ADMINENDPOINT_HPP
+#define ADMINENDPOINT_HPP
+
+#include "IRC.hpp"
+#include "Poller.hpp"
+#include "MetricsSnapshot.hpp"
+#include <map>
+#include <string>
+
+#define ADMIN_MAX_CONNECTIONS 8
+#define ADMIN_REQUEST_MAX 4096
+#define ADMIN_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+// Metrics listener on a Unix-domain socket (mode 0600) or a loopback TCP
+// port, answering "GET /metrics" over HTTP/1.0 in Prometheus text format
+// and "GET /trace" with the stall watchdog's log as JSON lines.
+// Its sockets live in a private epoll instance whose fd the first reactor
+// watches like any other, so scrapes are served on that reactor's thread
+// between client events. A scrape in progress keeps its connection
+// registered for writing: the socket stays writable, so the reactor comes
+// back on every iteration and the snapshot advances one slice at a time.
+class AdminEndpoint {
+private:
+    enum State {
+        READING,
+        WALKING,
+        WRITING
+    };
+
+    struct Connection {
+        State state;
+        std::string request;
+        std::string response;
+        size_t sent;
+        MetricsSnapshot* snapshot;
+    };
+
+    Server* _server;
+    std::string _name;
+    std::string _path; // Unlinked on shutdown; empty for TCP
+    int _listenSocket;
+    EpollPoller _poller;
+    std::map<int, Connection> _connections;
+    std::vector<PollEvent> _events;
+
+    AdminEndpoint(const AdminEndpoint& other);
+    AdminEndpoint& operator=(const AdminEndpoint& other);
+
+    void listenUnix(const std::string& path);
+    void listenTcp(int port);
+    void acceptConnections();
+    void handleRead(int fd, Connection& connection);
+    void handleWrite(int fd, Connection& connection);
+    void respond(int fd, Connection& connection, const char* status, const std::string& body,
+                 const char* contentType = ADMIN_CONTENT_TYPE);
+    void closeConnection(int fd);
+
+public:
+    // A port number listens on 127.0.0.1, anything else is a socket path
+    AdminEndpoint(Server* server, const std::string& endpoint);
+    ~AdminEndpoint();
+
+    const std::string& getName() const;
+
+    // Readable whenever poll() has work to do
+    int getFd() const;
+    void poll();
+};
+
+#endif // ADMINENDPOINT_HPP
@@ -0,0 +1,46 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include "StringView.hpp"
+#include <cstddef>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+// Bump-pointer scratch memory owned by one reactor and reset at the end of
+// each event-loop iteration. Parsed targets and formatted lines live here
+// until they are copied into a SharedBuffer, so nothing allocated from the
+// arena may be kept past the iteration. Blocks survive reset() and are
+// reused, so a steady workload stops allocating once warmed up; a request
+// larger than a block gets a block of its own, freed on reset().
+class Arena {
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    Block* _blocks;
+    Block* _current;
+    Block* _oversized;
+    char* _cursor;
+    char* _limit;
+
+    Arena(const Arena& other);
+    Arena& operator=(const Arena& other);
+
+    Block* createBlock(size_t size);
+    void useBlock(Block* block);
+
+public:
+    Arena();
+    ~Arena();
+
+    // Pointer-aligned; throws std::bad_alloc like operator new
+    void* allocate(size_t size);
+    void reset();
+
+    // Concatenates the parts into one arena-backed view
+    StringView join(const StringView* parts, size_t count);
+};
+
+#endif // ARENA_HPP
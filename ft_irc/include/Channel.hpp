@@ -1,59 +1,102 @@
-#ifndef CHANNEL_HPP
-#define CHANNEL_HPP
-
-#include "IRC.hpp"
-#include <string>
-
-class Client;
-
-class Channel {
-private:
-    std::string _name;
-    std::string _topic;
-    std::string _key;
-    std::set<Client*> _clients;
-    std::set<Client*> _operators;
-    std::string _mode;
-    size_t _userLimit;
-
-public:
-    Channel(const std::string& name);
-    ~Channel();
-
-    // Getters
-    const std::string& getName() const;
-    const std::string& getTopic() const;
-    const std::string& getKey() const;
-    const std::set<Client*>& getClients() const;
-    const std::set<Client*>& getOperators() const;
-    const std::string& getMode() const;
-    size_t getUserLimit() const;
-
-    // Setters
-    void setTopic(const std::string& topic);
-    void setKey(const std::string& key);
-    void setMode(const std::string& mode);
-    void setUserLimit(size_t limit);
-
-    // Client operations
-    void addClient(Client* client);
-    void removeClient(Client* client);
-    bool hasClient(Client* client) const;
-    bool isOperator(Client* client) const;
-    void addOperator(Client* client);
-    void removeOperator(Client* client);
-
-    // Mode operations
-    bool hasMode(char mode) const;
-    void addMode(char mode);
-    void removeMode(char mode);
-
-    // Channel operations
-    void broadcast(const std::string& message, Client* sender = NULL);
-    bool isInviteOnly() const;
-    bool isModerated() const;
-    bool isSecret() const;
-    bool isProtected() const;
-};
-
-#endif // CHANNEL_HPP 
\ No newline at end of file
+#ifndef CHANNEL_HPP
+#define CHANNEL_HPP
+
+#include "IRC.hpp"
+#include "ObjectPool.hpp"
+#include "StringView.hpp"
+#include <string>
+
+class Client;
+class SharedBuffer;
+
+// Per-member status bits
+#define MEMBER_OPERATOR 0x01
+#define MEMBER_VOICE 0x02
+
+// Members live in one contiguous array so a broadcast is a linear scan;
+// _memberIndex maps a member's fd to its slot for O(1) membership tests.
+// Removal swaps the last member into the freed slot.
+//
+// The NAMES reply is kept pre-serialized as 353 chunks that each fit in one
+// line. A join appends to the last chunk; departures, status and nickname
+// changes mark the list stale and it is rebuilt on the next request.
+class Channel {
+public:
+    struct Member {
+        Client* client;
+        unsigned char status;
+    };
+
+private:
+    typedef std::tr1::unordered_map<int, size_t> MemberIndex;
+
+    std::string _name;
+    std::string _topic;
+    std::string _key;
+    std::vector<Member> _members;
+    MemberIndex _memberIndex;
+    ModeSet _modes;
+    size_t _userLimit;
+    std::vector<std::string> _names;
+    std::vector<const SharedBuffer*> _namesLines;
+    bool _namesStale;
+
+    Member* findMember(Client* client);
+    const Member* findMember(Client* client) const;
+    void appendName(const Member& member);
+    void rebuildNames();
+    void clearNames();
+
+public:
+    Channel(const std::string& name);
+    ~Channel();
+
+    // Storage comes from a slab pool
+    static void* operator new(size_t size);
+    static void operator delete(void* object);
+    static ObjectPool& getPool();
+
+    // Getters
+    const std::string& getName() const;
+    const std::string& getTopic() const;
+    const std::string& getKey() const;
+    const std::vector<Member>& getMembers() const;
+    size_t size() const;
+    bool empty() const;
+    std::string getMode() const;
+    size_t getUserLimit() const;
+
+    // Setters
+    void setTopic(const std::string& topic);
+    void setKey(const std::string& key);
+    void setMode(const std::string& mode);
+    void setUserLimit(size_t limit);
+
+    // Client operations
+    void addClient(Client* client);
+    void removeClient(Client* client);
+    bool hasClient(Client* client) const;
+    bool hasStatus(Client* client, unsigned char status) const;
+    void setStatus(Client* client, unsigned char status, bool enabled);
+    bool isOperator(Client* client) const;
+    void addOperator(Client* client);
+    void removeOperator(Client* client);
+
+    // Mode operations
+    bool hasMode(char mode) const;
+    void addMode(char mode);
+    void removeMode(char mode);
+
+    // Channel operations
+    void broadcast(const std::string& line, Client* except = NULL);
+    void broadcast(const StringView& line, Client* except = NULL);
+    void sendNames(Client* client);
+    void invalidateNames();
+    bool isInviteOnly() const;
+    bool isModerated() const;
+    bool isSecret() const;
+    bool isProtected() const;
+    bool isPersistent() const;
+};
+
+#endif // CHANNEL_HPP
@@ -1,64 +1,98 @@
-#ifndef CLIENT_HPP
-#define CLIENT_HPP
-
-#include "IRC.hpp"
-#include <string>
-
-class Channel;
-
-class Client {
-private:
-    int _fd;
-    std::string _nickname;
-    std::string _username;
-    std::string _realname;
-    std::string _hostname;
-    std::string _buffer;
-    bool _registered;
-    bool _authenticated;
-    std::set<Channel*> _channels;
-    std::string _mode;
-
-public:
-    Client(int fd);
-    ~Client();
-
-    // Getters
-    int getFd() const;
-    const std::string& getNickname() const;
-    const std::string& getUsername() const;
-    const std::string& getRealname() const;
-    const std::string& getHostname() const;
-    const std::string& getBuffer() const;
-    bool isRegistered() const;
-    bool isAuthenticated() const;
-    const std::set<Channel*>& getChannels() const;
-    const std::string& getMode() const;
-
-    // Setters
-    void setNickname(const std::string& nickname);
-    void setUsername(const std::string& username);
-    void setRealname(const std::string& realname);
-    void setHostname(const std::string& hostname);
-    void setRegistered(bool registered);
-    void setAuthenticated(bool authenticated);
-    void setMode(const std::string& mode);
-
-    // Channel operations
-    void addChannel(Channel* channel);
-    void removeChannel(Channel* channel);
-    bool isInChannel(const std::string& channelName) const;
-
-    // Buffer operations
-    void appendToBuffer(const std::string& data);
-    void clearBuffer();
-    bool hasCompleteCommand() const;
-    std::string getNextCommand();
-
-    // Mode operations
-    bool hasMode(char mode) const;
-    void addMode(char mode);
-    void removeMode(char mode);
-};
-
+#ifndef CLIENT_HPP
+#define CLIENT_HPP
+
+#include "IRC.hpp"
+#include "InputBuffer.hpp"
+#include "OutputQueue.hpp"
+#include "ObjectPool.hpp"
+#include "InternedString.hpp"
+#include <string>
+
+class Channel;
+class Reactor;
+
+class Client {
+private:
+    int _fd;
+    InternedString _nickname;
+    InternedString _username;
+    InternedString _realname;
+    InternedString _hostname;
+    std::string _source;
+    bool _registered;
+    bool _authenticated;
+    std::set<Channel*> _channels;
+    ModeSet _modes;
+    InputBuffer _input;
+    OutputQueue _output;
+    bool _writeWatched;
+    Reactor* _reactor;
+    in_addr_t _address;
+    unsigned long _epoch;
+
+    void updateSource();
+
+public:
+    Client(int fd, Reactor* reactor = NULL, in_addr_t address = INADDR_ANY);
+    ~Client();
+
+    // Storage comes from a slab pool shared by every reactor
+    static void* operator new(size_t size);
+    static void operator delete(void* object);
+    static ObjectPool& getPool();
+
+    // Getters
+    int getFd() const;
+    const std::string& getNickname() const;
+    const InternedString& getNicknameHandle() const;
+    const std::string& getUsername() const;
+    const std::string& getRealname() const;
+    const std::string& getHostname() const;
+    const std::string& getSource() const;
+    bool isRegistered() const;
+    bool isAuthenticated() const;
+    const std::set<Channel*>& getChannels() const;
+    std::string getMode() const;
+    Reactor* getReactor() const;
+    in_addr_t getAddress() const;
+
+    // Setters
+    void setNickname(const std::string& nickname);
+    void setUsername(const std::string& username);
+    void setRealname(const std::string& realname);
+    void setHostname(const std::string& hostname);
+    void setRegistered(bool registered);
+    void setAuthenticated(bool authenticated);
+    void setMode(const std::string& mode);
+
+    // Channel operations
+    void addChannel(Channel* channel);
+    void removeChannel(Channel* channel);
+    bool isInChannel(const std::string& channelName) const;
+
+    // Input operations
+    InputBuffer& getInput();
+
+    // Output operations
+    void sendMessage(const std::string& message);
+    void sendMessage(const StringView& message);
+    void sendMessage(const SharedBuffer* message);
+    // Queues a buffer another reactor posted; owning thread only
+    void deliver(const SharedBuffer* message);
+    bool hasPendingOutput() const;
+    size_t getPendingOutput() const;
+    OutputQueue& getOutputQueue();
+    ssize_t flushOutput();
+    bool isWriteWatched() const;
+    void setWriteWatched(bool watched);
+
+    // Fan-out deduplication; false if already stamped with this epoch
+    bool stampEpoch(unsigned long epoch);
+
+    // Mode operations
+    bool hasMode(char mode) const;
+    void addMode(char mode);
+    void removeMode(char mode);
+};
+
 #endif // CLIENT_HPP 
\ No newline at end of file
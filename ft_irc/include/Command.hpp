@@ -1,52 +1,84 @@
-#ifndef COMMAND_HPP
-#define COMMAND_HPP
-
-#include "IRC.hpp"
-#include <string>
-#include <vector>
-
-class Client;
-class Server;
-
-
-class Command {
-private:
-    std::string _name;
-    std::vector<std::string> _args;
-    Client* _client;
-    Server* _server;
-
-public:
-    Command(const std::string& rawCommand, Client* client, Server* server);
-    ~Command();
-
-    // Getters
-    const std::string& getName() const;
-    const std::vector<std::string>& getArgs() const;
-    Client* getClient() const;
-    Server* getServer() const;
-
-    // Command parsing
-    static std::vector<std::string> parseCommand(const std::string& rawCommand);
-    static bool isValidNickname(const std::string& nickname);
-    static bool isValidChannelName(const std::string& channelName);
-
-    // Command execution
-    void execute();
-    void executePass();
-    void executeNick();
-    void executeUser();
-    void executeQuit();
-    void executeJoin();
-    void executePart();
-    void executePrivmsg();
-    void executeNotice();
-    void executeKick();
-    void executeInvite();
-    void executeTopic();
-    void executeMode();
-    void executePing();
-    void executePong();
-};
-
-#endif // COMMAND_HPP 
+#ifndef COMMAND_HPP
+#define COMMAND_HPP
+
+#include "IRC.hpp"
+#include "Message.hpp"
+#include "Arena.hpp"
+#include <string>
+#include <vector>
+
+class Client;
+class Server;
+
+
+class Command {
+public:
+    // Registry entry; requirements are checked once before the handler runs
+    struct Spec {
+        const char* name;
+        void (Command::*handler)();
+        size_t minParams;           // Fewer draw ERR_NEEDMOREPARAMS
+        bool requiresRegistration;  // Unregistered clients draw ERR_NOTREGISTERED
+        bool shared;                // Only reads shared state; see isShared
+    };
+
+private:
+    const Spec* _spec;
+    Message _message;
+    Client* _client;
+    Server* _server;
+    Arena& _arena;
+
+    void sendReply(const std::string& reply);
+    size_t argCount() const;
+    std::string arg(size_t index) const;
+    StringView relayLine(const char* command, const StringView& target);
+
+public:
+    Command(const StringView& line, Client* client, Server* server);
+    ~Command();
+
+    // Getters
+    const Spec* getSpec() const;
+    const Message& getMessage() const;
+    Client* getClient() const;
+    Server* getServer() const;
+
+    // Registry index of the verb for Stats, STATS_UNKNOWN_COMMAND for
+    // unknown verbs, or -1 for a blank line
+    int getSlot() const;
+
+    // True when the command only reads nicks and channels, so it may run
+    // under the shared state lock alongside other reactors. Such commands
+    // change nothing but their own client and reactor; output for clients
+    // of other reactors goes through those reactors' inboxes.
+    bool isShared() const;
+
+    // Command parsing
+    static const Spec* lookup(const StringView& verb);
+    static const Spec* getRegistry(size_t& count);
+    static bool isValidNickname(const std::string& nickname);
+    static bool isValidChannelName(const std::string& channelName);
+
+    // Command execution
+    void execute();
+    void executePass();
+    void executeNick();
+    void executeUser();
+    void executeQuit();
+    void executeJoin();
+    void executePart();
+    void executePrivmsg();
+    void executeNotice();
+    void executeKick();
+    void executeInvite();
+    void executeTopic();
+    void executeMode();
+    void executePing();
+    void executePong();
+    void executeNames();
+    void executeOper();
+    void executeStats();
+};
+
+#endif // COMMAND_HPP 
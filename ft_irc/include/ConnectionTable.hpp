@@ -0,0 +1,47 @@
+#ifndef CONNECTIONTABLE_HPP
+#define CONNECTIONTABLE_HPP
+
+#include "IRC.hpp"
+#include <vector>
+
+class Client;
+
+// Dense fd-indexed client table. Lookup, insert and removal are O(1); the
+// live clients are also kept in a packed array (swap-remove) for iteration.
+class ConnectionTable {
+public:
+    // Identifies one connection; becomes stale once its fd slot is reused
+    struct Handle {
+        int fd;
+        unsigned int generation;
+    };
+
+private:
+    struct Slot {
+        Client* client;
+        unsigned int generation;
+        size_t index; // Position in _dense
+    };
+
+    std::vector<Slot> _slots;
+    std::vector<Client*> _dense;
+
+public:
+    ConnectionTable();
+    ~ConnectionTable();
+
+    // Getters
+    size_t size() const;
+    bool empty() const;
+    const std::vector<Client*>& getClients() const;
+
+    // Table operations
+    Handle insert(int fd, Client* client);
+    Client* remove(int fd);
+    Client* find(int fd) const;
+    Client* find(const Handle& handle) const;
+    Handle getHandle(int fd) const;
+    bool isValid(const Handle& handle) const;
+};
+
+#endif // CONNECTIONTABLE_HPP
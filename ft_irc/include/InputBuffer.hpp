@@ -0,0 +1,51 @@
+#ifndef INPUTBUFFER_HPP
+#define INPUTBUFFER_HPP
+
+#include "IRC.hpp"
+#include "StringView.hpp"
+
+#define INPUT_BUFFER_SIZE 8192
+
+// Fixed-capacity compacting buffer for one connection's inbound bytes.
+// Sockets read straight into the free tail; complete lines end at LF, with an
+// optional CR before it, and are handed out as views without the terminator
+// or any stray CR and NUL, valid until the next reserve() or append(). The
+// LF search resumes where the previous one stopped. The
+// unconsumed remainder slides to the front only when the tail runs short.
+class InputBuffer {
+private:
+    char _data[INPUT_BUFFER_SIZE];
+    size_t _start;
+    size_t _end;
+    size_t _scan;
+    bool _discarding;
+
+    InputBuffer(const InputBuffer& other);
+    InputBuffer& operator=(const InputBuffer& other);
+
+    void compact();
+
+public:
+    enum Status {
+        LINE_NONE,
+        LINE_READY,
+        LINE_TOO_LONG
+    };
+
+    InputBuffer();
+    ~InputBuffer();
+
+    // Getters
+    size_t size() const;
+
+    // Filling: reserve() returns the free tail, commit() accounts for bytes written there
+    char* reserve(size_t& available);
+    void commit(size_t length);
+    size_t append(const char* data, size_t length);
+    void clear();
+
+    // Framing; a line longer than MAX_LINE_LENGTH is dropped and reported once
+    Status next(StringView& line);
+};
+
+#endif // INPUTBUFFER_HPP
@@ -0,0 +1,40 @@
+#ifndef INTERNEDSTRING_HPP
+#define INTERNEDSTRING_HPP
+
+#include "IRC.hpp"
+#include <string>
+
+// Handle to an identity string (nickname, username, realname, hostname)
+// stored once in a process-wide table. Every client with the same value
+// holds a reference to the same entry, so thousands of users behind one
+// NAT share a single hostname and equal values compare by pointer. Entries
+// are freed with their last handle. The table has its own lock because
+// clients are created and destroyed on every reactor thread.
+class InternedString {
+private:
+    typedef std::tr1::unordered_map<std::string, unsigned int> Table;
+    typedef Table::value_type Entry;
+
+    Entry* _entry; // NULL for the empty string
+
+    static Entry* acquire(const std::string& value);
+    static void retain(Entry* entry);
+    static void release(Entry* entry);
+
+public:
+    InternedString();
+    explicit InternedString(const std::string& value);
+    InternedString(const InternedString& other);
+    InternedString& operator=(const InternedString& other);
+    ~InternedString();
+
+    const std::string& str() const;
+    bool empty() const;
+    bool operator==(const InternedString& other) const;
+    bool operator!=(const InternedString& other) const;
+
+    // Distinct values currently interned
+    static size_t count();
+};
+
+#endif // INTERNEDSTRING_HPP
@@ -0,0 +1,66 @@
+#ifndef IOURING_HPP
+#define IOURING_HPP
+
+#include <linux/io_uring.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal io_uring wrapper over the raw syscalls: one submission/completion
+// ring pair plus a single provided-buffer ring used by multishot recv.
+class IoUring {
+private:
+    int _ringFd;
+
+    // Submission ring
+    void* _sqRing;
+    size_t _sqRingSize;
+    unsigned* _sqHead;
+    unsigned* _sqTail;
+    unsigned* _sqMask;
+    unsigned* _sqArray;
+    unsigned _sqEntries;
+    struct io_uring_sqe* _sqes;
+    size_t _sqesSize;
+    unsigned _sqLocalTail;
+    unsigned _toSubmit;
+
+    // Completion ring
+    void* _cqRing;
+    size_t _cqRingSize;
+    unsigned* _cqHead;
+    unsigned* _cqTail;
+    unsigned* _cqMask;
+    struct io_uring_cqe* _cqes;
+
+    // Provided buffers
+    struct io_uring_buf_ring* _bufRing;
+    size_t _bufRingSize;
+    char* _bufMemory;
+    unsigned _bufCount;
+    size_t _bufSize;
+    unsigned short _bufTail;
+    unsigned short _bufGroup;
+
+    IoUring(const IoUring& other);
+    IoUring& operator=(const IoUring& other);
+
+public:
+    explicit IoUring(unsigned entries);
+    ~IoUring();
+
+    // Submission
+    struct io_uring_sqe* getSqe();
+    int submitAndWait(unsigned waitFor);
+
+    // Completion
+    struct io_uring_cqe* peekCompletion();
+    void advanceCompletion();
+
+    // Provided buffers
+    void setupBuffers(unsigned short group, unsigned count, size_t size);
+    unsigned short getBufferGroup() const;
+    char* getBuffer(unsigned short id) const;
+    void recycleBuffer(unsigned short id);
+};
+
+#endif // IOURING_HPP
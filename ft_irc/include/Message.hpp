@@ -0,0 +1,35 @@
+#ifndef MESSAGE_HPP
+#define MESSAGE_HPP
+
+#include "StringView.hpp"
+
+#define MAX_PARAMS 15
+
+// One parsed IRC line:
+//   ['@' tags ' '] [':' prefix ' '] command {' ' middle} [' ' ':' trailing]
+// Every field is a view into the parsed line, so parsing allocates nothing
+// and the result is only valid while that line is.
+class Message {
+private:
+    StringView _tags;
+    StringView _prefix;
+    StringView _command;
+    StringView _params[MAX_PARAMS];
+    size_t _paramCount;
+
+public:
+    Message();
+
+    // Returns false for a line without a command or with a CR, LF or NUL
+    // anywhere in it; callers ignore such a line
+    bool parse(const StringView& line);
+
+    // Getters; tags and prefix exclude their leading '@' or ':'
+    const StringView& getTags() const;
+    const StringView& getPrefix() const;
+    const StringView& getCommand() const;
+    size_t getParamCount() const;
+    const StringView& getParam(size_t index) const;
+};
+
+#endif // MESSAGE_HPP
@@ -0,0 +1,67 @@
+#ifndef METRICSSNAPSHOT_HPP
+#define METRICSSNAPSHOT_HPP
+
+#include "IRC.hpp"
+#include <string>
+
+// Longest the walk holds the state lock in one slice, and how many items
+// it visits between clock reads
+#define SNAPSHOT_SLICE_NS 200000
+#define SNAPSHOT_CHECK_INTERVAL 128
+
+#define SNAPSHOT_MEMBER_BUCKETS 13
+#define SNAPSHOT_CHANNEL_BUCKETS 8
+
+// Server state for one metrics scrape, in Prometheus text format. Walking
+// every client and channel of a large server takes milliseconds, so the
+// walk is split into slices of at most SNAPSHOT_SLICE_NS, each under its
+// own acquisition of the state lock; the event loop serves clients between
+// slices. The walk is not atomic: a client or channel that comes or goes
+// mid-scrape may be missed, so per-client sums are approximate under churn.
+class MetricsSnapshot {
+private:
+    enum Phase {
+        WALK_CLIENTS,
+        WALK_CHANNELS,
+        DONE
+    };
+
+    Server* _server;
+    Phase _phase;
+    size_t _reactor;        // Client walk cursor
+    size_t _index;
+    size_t _bucket;         // Channel walk cursor
+    size_t _bucketCount;    // Restart the channel walk if the table rehashes
+
+    uint64_t _clients;
+    uint64_t _registered;
+    uint64_t _queuedBytes;
+    uint64_t _maxQueuedBytes;
+    uint64_t _clientChannels[SNAPSHOT_CHANNEL_BUCKETS];
+    uint64_t _channels;
+    uint64_t _memberships;
+    uint64_t _channelMembers[SNAPSHOT_MEMBER_BUCKETS];
+
+    uint64_t _started;
+    uint64_t _longestSlice;
+    uint64_t _slices;
+
+    MetricsSnapshot(const MetricsSnapshot& other);
+    MetricsSnapshot& operator=(const MetricsSnapshot& other);
+
+    bool walkClients(uint64_t deadline);
+    bool walkChannels(uint64_t deadline);
+    void resetChannels();
+
+public:
+    explicit MetricsSnapshot(Server* server);
+
+    // Runs one slice; true once the walk is complete
+    bool advance();
+    bool isComplete() const;
+
+    // Walk results plus counters that need no walk
+    std::string render() const;
+};
+
+#endif // METRICSSNAPSHOT_HPP
@@ -0,0 +1,55 @@
+#ifndef MUTEX_HPP
+#define MUTEX_HPP
+
+#include <pthread.h>
+
+class Mutex {
+private:
+    pthread_mutex_t _mutex;
+
+    Mutex(const Mutex& other);
+    Mutex& operator=(const Mutex& other);
+
+public:
+    Mutex();
+    ~Mutex();
+
+    void lock();
+    void unlock();
+};
+
+// Readers-writer lock. Writers are preferred, so a steady stream of
+// readers cannot keep one waiting forever.
+class SharedMutex {
+private:
+    pthread_rwlock_t _lock;
+
+    SharedMutex(const SharedMutex& other);
+    SharedMutex& operator=(const SharedMutex& other);
+
+public:
+    SharedMutex();
+    ~SharedMutex();
+
+    void lock();
+    void lockShared();
+    void unlock();
+};
+
+// Holds a Mutex, or a SharedMutex exclusively or shared, for the lifetime
+// of the enclosing scope
+class ScopedLock {
+private:
+    Mutex* _mutex;
+    SharedMutex* _shared;
+
+    ScopedLock(const ScopedLock& other);
+    ScopedLock& operator=(const ScopedLock& other);
+
+public:
+    explicit ScopedLock(Mutex& mutex);
+    explicit ScopedLock(SharedMutex& mutex, bool shared = false);
+    ~ScopedLock();
+};
+
+#endif // MUTEX_HPP
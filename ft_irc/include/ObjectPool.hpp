@@ -0,0 +1,89 @@
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include "Mutex.hpp"
+#include <cstddef>
+#include <vector>
+
+#define POOL_SLAB_SIZE (2 * 1024 * 1024)
+#define POOL_ALIGNMENT 16
+#define POOL_CACHED_MAX 8       // Pools that may keep per-thread caches
+#define POOL_CACHE_BATCH 32     // Slots moved between a thread cache and its pool at once
+#define POOL_CACHE_LIMIT 64     // Slots a thread cache holds before it returns a batch
+
+// Fixed-size slab allocator behind the class-level operator new of Client
+// and Channel. Slabs are 2 MiB anonymous mappings, optionally huge pages,
+// carved into slots as they are needed. A freed slot goes on an intrusive
+// free list and is handed out again before any new slot is carved, so
+// connection churn settles on a fixed footprint. Slabs are never returned
+// to the system.
+//
+// A thread-cached pool also gives each thread a private free list, so the
+// common allocate and release take no lock. The list is refilled from the
+// pool, and returned to it, POOL_CACHE_BATCH slots at a time; a slot freed
+// on another thread than the one that took it simply joins that thread's
+// list. Its statistics move in the same batches, so slots parked in thread
+// caches count as in use.
+class ObjectPool {
+public:
+    struct Stats {
+        size_t slotSize;
+        size_t slabs;
+        size_t hugeSlabs;
+        size_t capacity;
+        size_t inUse;
+        size_t peak;
+        size_t allocations;
+    };
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    // Plain data so that it can be thread-local
+    struct ThreadCache {
+        FreeSlot* head;
+        size_t count;
+    };
+
+    static __thread ThreadCache _threadCaches[POOL_CACHED_MAX];
+    static unsigned int _cachedPools;
+
+    const char* _name;
+    size_t _slotSize;
+    size_t _slabSize;
+    std::vector<void*> _slabs;
+    FreeSlot* _free;
+    char* _cursor;
+    char* _limit;
+    bool _hugePages;
+    int _cacheIndex;    // Index into _threadCaches, or -1 when not cached
+    Stats _stats;
+    Mutex _mutex;
+
+    ObjectPool(const ObjectPool& other);
+    ObjectPool& operator=(const ObjectPool& other);
+
+    void mapSlab();
+    void* take();
+    void give(void* object);
+    void refill(ThreadCache& cache);
+    void drain(ThreadCache& cache);
+
+public:
+    // At most POOL_CACHED_MAX pools can be thread-cached; later ones are not
+    ObjectPool(const char* name, size_t objectSize, bool threadCached = false);
+
+    // Throws std::bad_alloc when a slab cannot be mapped
+    void* allocate(size_t size);
+    void release(void* object);
+
+    // Applies to slabs mapped from now on
+    void setHugePages(bool enabled);
+
+    const char* getName() const;
+    Stats getStats();
+};
+
+#endif // OBJECTPOOL_HPP
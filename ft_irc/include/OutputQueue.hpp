@@ -0,0 +1,57 @@
+#ifndef OUTPUTQUEUE_HPP
+#define OUTPUTQUEUE_HPP
+
+#include "IRC.hpp"
+#include "SharedBuffer.hpp"
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+#define OUTPUT_IOV_MAX 64
+
+// Pending outbound bytes for one connection, held as references to shared
+// buffers. A short write leaves _offset pointing at the first unsent byte
+// of the front chunk. Chunks are handed to writev() in batches of up to
+// OUTPUT_IOV_MAX. The chunk pointers sit in a power-of-two ring that only
+// grows, so a connection in steady state queues without allocating.
+// A peer that stops reading is capped at MAX_SENDQ bytes: the push that
+// would cross it is refused, and so is every push after it until clear().
+class OutputQueue {
+private:
+    std::vector<const SharedBuffer*> _chunks;
+    size_t _head;
+    size_t _count;
+    size_t _offset;
+    size_t _size;
+    bool _overflowed;
+
+    const SharedBuffer* chunk(size_t index) const;
+    void grow();
+
+    OutputQueue(const OutputQueue& other);
+    OutputQueue& operator=(const OutputQueue& other);
+
+public:
+    OutputQueue();
+    ~OutputQueue();
+
+    // Getters; size() may be read from any thread
+    bool empty() const;
+    size_t size() const;
+    bool isOverflowed() const;
+    bool isAtBoundary() const;      // Nothing of the front chunk is sent yet
+
+    // Queue operations; false once the queue has overflowed
+    bool push(const std::string& data);
+    bool push(const SharedBuffer* buffer);
+    void clear();
+
+    // Fills up to max iovecs from the front of the queue; chunks may be NULL
+    int prepare(struct iovec* iov, const SharedBuffer** chunks, int max) const;
+    void consume(size_t bytes);
+
+    // Writes as much as the socket accepts; returns -1 on a fatal socket error
+    ssize_t flush(int fd);
+};
+
+#endif // OUTPUTQUEUE_HPP
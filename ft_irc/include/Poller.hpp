@@ -0,0 +1,82 @@
+#ifndef POLLER_HPP
+#define POLLER_HPP
+
+#include "IRC.hpp"
+#include <string>
+#include <vector>
+#include <sys/epoll.h>
+
+struct PollEvent {
+    int fd;
+    unsigned int events;
+};
+
+// Readiness notification backend used by Server::run. Only ready fds are
+// reported back, so the event loop never walks idle connections.
+class Poller {
+public:
+    enum Backend {
+        BACKEND_POLL,
+        BACKEND_EPOLL,
+        BACKEND_IO_URING // Completion-based; served by UringReactor, not a Poller
+    };
+
+    // Interest / readiness flags
+    static const unsigned int READ = 0x1;
+    static const unsigned int WRITE = 0x2;
+    static const unsigned int HANGUP = 0x4;
+    static const unsigned int EDGE = 0x8; // Edge-triggered where supported
+
+    virtual ~Poller();
+
+    virtual void add(int fd, unsigned int events) = 0;
+    virtual void modify(int fd, unsigned int events) = 0;
+    virtual void remove(int fd) = 0;
+    virtual int wait(std::vector<PollEvent>& ready, int timeout) = 0;
+    virtual const char* getName() const = 0;
+
+    static Poller* create(Backend backend);
+    static bool parseBackend(const std::string& name, Backend& backend);
+};
+
+class PollPoller : public Poller {
+private:
+    std::vector<pollfd> _pollfds;
+    std::vector<int> _index; // fd -> position in _pollfds, -1 when absent
+
+    static short toPollEvents(unsigned int events);
+
+public:
+    PollPoller();
+    ~PollPoller();
+
+    void add(int fd, unsigned int events);
+    void modify(int fd, unsigned int events);
+    void remove(int fd);
+    int wait(std::vector<PollEvent>& ready, int timeout);
+    const char* getName() const;
+};
+
+class EpollPoller : public Poller {
+private:
+    int _epollFd;
+    std::vector<struct epoll_event> _events;
+
+    static uint32_t toEpollEvents(unsigned int events);
+
+public:
+    EpollPoller();
+    ~EpollPoller();
+
+    void add(int fd, unsigned int events);
+    void modify(int fd, unsigned int events);
+    void remove(int fd);
+    int wait(std::vector<PollEvent>& ready, int timeout);
+    const char* getName() const;
+
+    // Readable while any registered fd is ready, so the poller can itself
+    // be watched by another event loop
+    int getFd() const;
+};
+
+#endif // POLLER_HPP
@@ -0,0 +1,123 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include "IRC.hpp"
+#include "Poller.hpp"
+#include "ConnectionTable.hpp"
+#include "SharedBuffer.hpp"
+#include "Mutex.hpp"
+#include "Arena.hpp"
+#include "Stats.hpp"
+#include <vector>
+#include <pthread.h>
+
+// Connections taken from the backlog per listener wakeup
+#define ACCEPT_BATCH 64
+
+// Queue size past which the reactor flushes before reading further input,
+// so a burst handled in one iteration cannot push a reading client past
+// MAX_SENDQ before the end-of-iteration flush
+#define EARLY_FLUSH_BYTES (MAX_SENDQ / 4)
+
+class Server;
+class Client;
+class AdminEndpoint;
+
+// One event loop: its own SO_REUSEPORT listener, poller and connection set.
+// Shared server state (nicks, channels) is only touched with the server's
+// state lock held, shared by commands that only read it and exclusively by
+// everything else; output for clients owned by another reactor is posted to
+// that reactor's inbox and delivered on its own thread.
+class Reactor {
+protected:
+    struct Delivery {
+        ConnectionTable::Handle handle;
+        const SharedBuffer* buffer;
+    };
+
+    Server* _server;
+    int _listenSocket;
+    int _wakeFd;
+    Poller* _poller;
+    ConnectionTable _clients;
+    std::vector<ConnectionTable::Handle> _pendingWrites;
+    bool _flushEarly;   // A queue passed EARLY_FLUSH_BYTES since the last flush
+    Mutex _inboxLock;
+    std::vector<Delivery> _inbox;
+    std::vector<Delivery> _delivering;
+    Arena _arena;
+    Stats _stats;
+    AdminEndpoint* _admin;
+    unsigned int _traceCountdown;
+    pthread_t _thread;
+
+    Reactor(const Reactor& other);
+    Reactor& operator=(const Reactor& other);
+
+    // Event handlers shared by the readiness and completion loops
+    void setupListener(int port);
+    void bindToCurrentThread();
+    void handleNewConnection();
+    bool acceptClient(int fd, in_addr_t address);
+    void handleClientData(Client* client);
+    void handleClientWrite(Client* client);
+    void handleClientDisconnect(Client* client);
+    void handleSendQueueExceeded(Client* client);
+    void handleWakeup();
+    bool processCommands(Client* client);
+    virtual void flushPendingWrites();
+    virtual void earlyFlush();
+    virtual bool isWriteInFlight(const Client* client) const;
+    void setWriteInterest(Client* client, bool enabled);
+    static void* threadMain(void* arg);
+
+    // poller may be NULL for completion-based subclasses
+    Reactor(Server* server, int port, Poller* poller);
+
+public:
+    virtual ~Reactor();
+
+    // Falls back to epoll when io_uring is unavailable
+    static Reactor* create(Server* server, int port, Poller::Backend backend);
+
+    // Getters
+    const ConnectionTable& getClients() const;
+    virtual const char* getBackendName() const;
+    int getPort() const;
+
+    // Scratch memory for the command being executed on this reactor's thread
+    Arena& getArena();
+
+    // Written by this reactor's thread only; see Stats
+    Stats& getStats();
+    const Stats& getStats() const;
+
+    // Watches the endpoint's fd from this loop
+    void attachAdmin(AdminEndpoint* admin);
+
+    // Loop control
+    virtual void run();
+    void startThread();
+    void joinThread();
+    bool isCurrentThread() const;
+
+    // Reactor bound to the calling thread, or NULL
+    static Reactor* getCurrent();
+
+    // Owning thread only; true on every interval-th call
+    bool sampleTrace(unsigned int interval);
+
+    // Client operations (shared state lock held)
+    virtual Client* addClient(int fd, in_addr_t address);
+    virtual void removeClient(Client* client);
+
+    // Output operations
+    void scheduleWrite(Client* client);
+    void requestEarlyFlush();
+    void post(Client* client, const SharedBuffer* buffer);
+
+    // Async-signal-safe: makes a blocked wait return
+    void wake();
+};
+
+#endif // REACTOR_HPP
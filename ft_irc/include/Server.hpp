@@ -1,65 +1,119 @@
-#ifndef SERVER_HPP
-#define SERVER_HPP
-
-#include "IRC.hpp"
-#include "Client.hpp"
-#include "Channel.hpp"
-#include <vector>
-
-class Server {
-private:
-    int _serverSocket;
-    std::string _password;
-    std::vector<pollfd> _pollfds;
-    ClientMap _clients;
-    ChannelMap _channels;
-    bool _running;
-
-    // Private methods
-    void setupServer(int port);
-    void handleNewConnection();
-    void handleClientData(Client* client);
-    void handleClientDisconnect(Client* client);
-    void processCommand(Client* client, const std::string& command);
-    void executeCommand(Client* client, const std::string& command, const std::vector<std::string>& args);
-    void broadcastToAll(const std::string& message, Client* sender = NULL);
-
-public:
-    Server(int port, const std::string& password);
-    ~Server();
-
-    // Server operations
-    void start();
-    void stop();
-    void run();
-
-    // Client operations
-    void addClient(int fd);
-    void removeClient(Client* client);
-    Client* getClient(const std::string& nickname);
-    bool isNicknameInUse(const std::string& nickname) const;
-
-    // Channel operations
-    Channel* getChannel(const std::string& name);
-    Channel* createChannel(const std::string& name);
-    void removeChannel(Channel* channel);
-    bool isChannelNameValid(const std::string& name) const;
-
-    // Command handlers
-    void handlePass(Client* client, const std::vector<std::string>& args);
-    void handleNick(Client* client, const std::vector<std::string>& args);
-    void handleUser(Client* client, const std::vector<std::string>& args);
-    void handleQuit(Client* client, const std::vector<std::string>& args);
-    void handleJoin(Client* client, const std::vector<std::string>& args);
-    void handlePart(Client* client, const std::vector<std::string>& args);
-    void handlePrivmsg(Client* client, const std::vector<std::string>& args);
-    void handleNotice(Client* client, const std::vector<std::string>& args);
-    void handleKick(Client* client, const std::vector<std::string>& args);
-    void handleInvite(Client* client, const std::vector<std::string>& args);
-    void handleTopic(Client* client, const std::vector<std::string>& args);
-    void handleMode(Client* client, const std::vector<std::string>& args);
-    void handlePing(Client* client, const std::vector<std::string>& args);
-    void handlePong(Client* client, const std::vector<std::string>& args);
-};
-
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "IRC.hpp"
+#include "Client.hpp"
+#include "Channel.hpp"
+#include "Poller.hpp"
+#include "Reactor.hpp"
+#include "Mutex.hpp"
+#include "Stats.hpp"
+#include "AdminEndpoint.hpp"
+#include "TraceLog.hpp"
+#include <vector>
+#include <tr1/unordered_map>
+
+#define MAX_THREADS 64
+
+// Live connections per peer address, for admission control
+typedef std::tr1::unordered_map<in_addr_t, unsigned int> AddressCountMap;
+
+// Clients by casefolded nickname hash; entries with colliding hashes are
+// told apart by comparing the folded nicknames themselves
+typedef std::tr1::unordered_multimap<size_t, Client*> NicknameIndex;
+
+class Server {
+private:
+    std::string _password;
+    std::string _operName;
+    std::string _operPassword;
+    time_t _startTime;
+    std::vector<Reactor*> _reactors;
+    AdminEndpoint* _admin;
+    SharedMutex _stateLock;
+    bool _corking;
+    size_t _clientCount;
+    size_t _maxClients;
+    unsigned int _maxClientsPerAddress;
+    AddressCountMap _addressCounts;
+    NicknameIndex _nicknames;
+    ChannelMap _channels;
+    unsigned long _broadcastEpoch;
+    TraceLog _trace;
+    uint64_t _traceBudget;          // Nanoseconds; 0 disables the watchdog
+    unsigned int _traceSampling;    // Trace 1 command in N; 0 disables sampling
+    volatile bool _running;
+
+    // Private methods
+    void setupServer(int port, Poller::Backend backend, size_t threads);
+
+public:
+    Server(int port, const std::string& password, Poller::Backend backend = Poller::BACKEND_EPOLL, size_t threads = 1);
+    ~Server();
+
+    // Server operations
+    void start();
+    void stop();
+    void run();
+    bool isRunning() const;
+    void setCorking(bool enabled);
+    bool isCorking() const;
+    const std::string& getPassword() const;
+    time_t getStartTime() const;
+    void setMaxClients(size_t limit);
+    void setMaxClientsPerAddress(unsigned int limit);
+
+    // OPER is refused outright until credentials are configured
+    void setOperator(const std::string& name, const std::string& password);
+    bool checkOperator(const std::string& name, const std::string& password) const;
+    bool hasOperator() const;
+
+    // Sums every reactor's counters into total, which starts out zeroed
+    void collectStats(Stats& total) const;
+
+    // Serves metrics from the first reactor's loop; see AdminEndpoint
+    void openAdmin(const std::string& endpoint);
+    const std::vector<Reactor*>& getReactors() const;
+
+    // Nick and channel state shared between reactors. Commands that only
+    // read it (Command::isShared) hold it shared, everything else exclusively
+    SharedMutex& getStateLock();
+
+    // Takes the state lock itself, in the mode the command needs
+    void processCommand(Client* client, const StringView& line);
+
+    // Stall watchdog: commands and loop iterations taking at least the
+    // budget, plus every Nth command when sampling, go to the trace log
+    void setTraceBudget(uint64_t nanoseconds);
+    void setTraceSampling(unsigned int interval);
+    uint64_t getTraceBudget() const;
+    unsigned int getTraceSampling() const;
+    const TraceLog& getTraceLog() const;
+    void traceIteration(uint64_t duration, size_t events, uint64_t bytes);
+
+    // Admission control (state lock held); checked before a Client is allocated
+    bool admitConnection(in_addr_t address);
+    void releaseConnection(in_addr_t address);
+
+    // Client operations
+    size_t getClientCount() const;
+    void removeClient(Client* client);
+    void detachClient(Client* client);
+    Client* getClient(const std::string& nickname);
+    Client* findClient(const StringView& nickname) const;
+    bool isNicknameInUse(const std::string& nickname) const;
+    void setNickname(Client* client, const std::string& nickname);
+    void removeNickname(Client* client);
+    void broadcastToPeers(Client* client, const std::string& message);
+
+    // Channel operations
+    const ChannelMap& getChannels() const;
+    Channel* getChannel(const std::string& name);
+    Channel* findChannel(const StringView& name) const;
+    Channel* createChannel(const std::string& name);
+    void removeChannel(Channel* channel);
+    void partChannel(Channel* channel, Client* client);
+    bool isChannelNameValid(const std::string& name) const;
+};
+
 #endif // SERVER_HPP 
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef SHAREDBUFFER_HPP
+#define SHAREDBUFFER_HPP
+
+#include "IRC.hpp"
+#include "StringView.hpp"
+#include "ObjectPool.hpp"
+#include <string>
+
+// Immutable, reference-counted serialized message. A broadcast builds one
+// and every recipient's OutputQueue holds a reference until it is flushed.
+// The bytes follow the header in the same allocation, which comes from a
+// size-class pool for anything up to SHAREDBUFFER_POOLED_MAX bytes.
+#define SHAREDBUFFER_POOLED_MAX 2048
+
+class SharedBuffer {
+private:
+    size_t _length;
+    mutable unsigned int _refs;
+    ObjectPool* _pool;
+
+    SharedBuffer(size_t length, ObjectPool* pool);
+    ~SharedBuffer();
+    SharedBuffer(const SharedBuffer& other);
+    SharedBuffer& operator=(const SharedBuffer& other);
+
+    static ObjectPool* poolFor(size_t size);
+
+public:
+    // Returns a buffer holding one reference owned by the caller
+    static SharedBuffer* create(const std::string& data);
+    static SharedBuffer* create(const StringView& data);
+
+    // Getters
+    const char* data() const;
+    size_t length() const;
+
+    // Reference counting
+    void retain() const;
+    void release() const;
+};
+
+#endif // SHAREDBUFFER_HPP
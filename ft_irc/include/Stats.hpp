@@ -0,0 +1,90 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+// Four linear sub-buckets per power of two, up to 2^41 ns (about 36 minutes)
+#define HISTOGRAM_SUB_BITS 2
+#define HISTOGRAM_BUCKETS 160
+
+// Command registry indices; the last slot counts unknown verbs
+#define STATS_COMMAND_SLOTS 32
+#define STATS_UNKNOWN_COMMAND (STATS_COMMAND_SLOTS - 1)
+
+// Latency histogram in the style of HdrHistogram: each power of two is split
+// into linear sub-buckets, so any value is reported within 25% of itself at
+// a fixed size and recording is a few shifts and one increment.
+class Histogram {
+private:
+    uint64_t _buckets[HISTOGRAM_BUCKETS];
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _max;
+
+public:
+    Histogram();
+
+    // Owning thread only
+    void record(uint64_t value);
+
+    // Safe against a concurrent record() on the other histogram
+    void merge(const Histogram& other);
+
+    uint64_t getCount() const;
+    uint64_t getSum() const;
+    uint64_t getMax() const;
+
+    // Upper bound of the bucket holding the given fraction of the values
+    uint64_t percentile(double fraction) const;
+
+    // Values below limit; exact when limit is a power of two
+    uint64_t countBelow(uint64_t limit) const;
+
+    static size_t bucketOf(uint64_t value);
+    static uint64_t bucketLimit(size_t index);
+};
+
+// Counters kept by one reactor. Only the reactor's own thread writes them,
+// with plain relaxed stores and no lock; STATS merges every reactor's set
+// from whichever thread runs it, with relaxed loads. Totals read that way
+// may be a few events stale but are never torn.
+class Stats {
+public:
+    enum Counter {
+        BYTES_IN,
+        BYTES_OUT,
+        ACCEPTS,
+        REJECTS,
+        DISCONNECTS,
+        BYTES_QUEUED,   // Output produced, counted by the producing reactor
+        COUNTER_COUNT
+    };
+
+private:
+    uint64_t _counters[COUNTER_COUNT];
+    Histogram _commands[STATS_COMMAND_SLOTS];
+    Histogram _iterations;
+
+    Stats(const Stats& other);
+    Stats& operator=(const Stats& other);
+
+public:
+    Stats();
+
+    // Owning thread only
+    void add(Counter counter, uint64_t amount = 1);
+    void recordCommand(size_t slot, uint64_t nanoseconds);
+    void recordIteration(uint64_t nanoseconds);
+
+    void merge(const Stats& other);
+
+    uint64_t get(Counter counter) const;
+    const Histogram& getCommand(size_t slot) const;
+    const Histogram& getIterations() const;
+
+    // CLOCK_MONOTONIC in nanoseconds
+    static uint64_t now();
+};
+
+#endif // STATS_HPP
@@ -0,0 +1,21 @@
+#ifndef STRINGVIEW_HPP
+#define STRINGVIEW_HPP
+
+#include <string>
+#include <cstddef>
+
+// Non-owning, non-terminated range of characters inside someone else's
+// buffer. Valid only as long as that buffer is left untouched.
+struct StringView {
+    const char* data;
+    size_t length;
+
+    static StringView from(const std::string& str);
+    static StringView from(const char* str);
+
+    bool empty() const;
+    bool equals(const char* str) const;
+    std::string str() const;
+};
+
+#endif // STRINGVIEW_HPP
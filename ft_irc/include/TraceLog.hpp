@@ -0,0 +1,64 @@
+#ifndef TRACELOG_HPP
+#define TRACELOG_HPP
+
+#include "Mutex.hpp"
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#define TRACE_CAPACITY 256
+#define TRACE_DEFAULT_BUDGET_US 10000
+#define TRACE_VERB_MAX 16
+#define TRACE_TARGET_MAX 64
+
+// One slow or sampled event. Fixed-size fields, so recording one never
+// allocates; longer verbs and targets are truncated.
+struct TraceRecord {
+    enum Kind {
+        COMMAND,    // One processCommand call
+        ITERATION   // One event-loop iteration, excluding the wait
+    };
+
+    enum Reason {
+        SLOW,       // Took at least the stall budget
+        SAMPLED     // Picked by 1-in-N sampling
+    };
+
+    Kind kind;
+    Reason reason;
+    uint64_t time;          // CLOCK_REALTIME, nanoseconds
+    uint64_t duration;      // Nanoseconds
+    uint64_t bytes;         // Output queued while it ran, over all recipients
+    size_t members;         // Size of the target channel afterwards, if any
+    size_t events;          // Ready events handled by the iteration
+    char verb[TRACE_VERB_MAX];
+    char target[TRACE_TARGET_MAX];
+};
+
+// Most recent TRACE_CAPACITY records from every reactor, oldest first.
+// Appends only happen for events over the stall budget or picked by
+// sampling, so a plain lock costs nothing on the common path.
+class TraceLog {
+private:
+    TraceRecord _records[TRACE_CAPACITY];
+    uint64_t _written;
+    mutable Mutex _mutex;
+
+    TraceLog(const TraceLog& other);
+    TraceLog& operator=(const TraceLog& other);
+
+public:
+    TraceLog();
+
+    void append(const TraceRecord& record);
+
+    // Copies the retained records, oldest first; returns how many were
+    // ever written, so records lost to wrap-around can be reported
+    uint64_t snapshot(std::vector<TraceRecord>& records) const;
+    uint64_t getWritten() const;
+
+    static void copyField(char* field, size_t size, const char* data, size_t length);
+    static uint64_t wallClock();
+};
+
+#endif // TRACELOG_HPP
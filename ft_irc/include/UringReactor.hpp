@@ -0,0 +1,65 @@
+#ifndef URINGREACTOR_HPP
+#define URINGREACTOR_HPP
+
+#include "Reactor.hpp"
+#include "IoUring.hpp"
+#include "OutputQueue.hpp"
+
+// Completion-based reactor: multishot accept replaces handleNewConnection,
+// multishot recv into a provided buffer ring replaces handleClientData, and
+// each loop iteration submits all pending writev requests together with the
+// wait for completions in a single io_uring_enter.
+class UringReactor : public Reactor {
+private:
+    // Tag stored in the low bits of each request's user_data
+    enum Operation {
+        OP_ACCEPT = 1,
+        OP_RECV = 2,
+        OP_SEND = 3,
+        OP_WAKEUP = 4,
+        OP_CANCEL = 5,
+        OP_ADMIN = 6
+    };
+
+    // A writev in flight; holds references so the bytes outlive the client
+    struct PendingSend {
+        ConnectionTable::Handle handle;
+        struct iovec iov[OUTPUT_IOV_MAX];
+        const SharedBuffer* chunks[OUTPUT_IOV_MAX];
+        int count;
+    };
+
+    IoUring _ring;
+    std::vector<PendingSend*> _spareSends;
+    std::vector<struct io_uring_cqe> _completions; // The batch being handled
+    std::vector<ConnectionTable::Handle> _deferredRecvs; // Re-arms the ring had no room for
+
+    static uint64_t encode(Operation op, int fd, unsigned int generation);
+
+    void armAccept();
+    void armWakeup();
+    void armAdmin();
+    void armRecv(int fd);
+    void armDeferredRecvs();
+    void handleCompletion(const struct io_uring_cqe& cqe);
+    void handleAccept(const struct io_uring_cqe& cqe);
+    void handleRecv(const struct io_uring_cqe& cqe);
+    void handleSend(const struct io_uring_cqe& cqe);
+    void flushPendingWrites();
+    void earlyFlush();
+    bool isWriteInFlight(const Client* client) const;
+    PendingSend* acquireSend();
+    void recycleSend(PendingSend* send);
+
+public:
+    UringReactor(Server* server, int port);
+    ~UringReactor();
+
+    const char* getBackendName() const;
+    void run();
+
+    Client* addClient(int fd, in_addr_t address);
+    void removeClient(Client* client);
+};
+
+#endif // URINGREACTOR_HPP
@@ -1,34 +1,48 @@
-#ifndef UTILS_HPP
-#define UTILS_HPP
-
-#include <string>
-#include <vector>
-
-namespace Utils {
-    // String operations
-    std::string trim(const std::string& str);
-    std::vector<std::string> split(const std::string& str, char delimiter);
-    std::string toUpper(const std::string& str);
-    std::string toLower(const std::string& str);
-    bool startsWith(const std::string& str, const std::string& prefix);
-    bool endsWith(const std::string& str, const std::string& suffix);
-
-    // IRC specific
-    bool isValidNickname(const std::string& nickname);
-    bool isValidChannelName(const std::string& channelName);
-    std::string getCurrentTimestamp();
-    std::string formatMessage(const std::string& prefix, const std::string& command, const std::string& params);
-    std::string formatReply(const std::string& code, const std::string& target, const std::string& message);
-
-    // Network operations
-    void setNonBlocking(int fd);
-    std::string getHostname();
-    std::string getIpAddress(int fd);
-    int getPort(int fd);
-
-    // Error handling
-    void handleError(const std::string& message);
-    void handleSignal(int signal);
-}
-
+#ifndef UTILS_HPP
+#define UTILS_HPP
+
+#include <string>
+#include <vector>
+#include "StringView.hpp"
+#include "IRC.hpp"
+#include "Arena.hpp"
+
+namespace Utils {
+    // String operations
+    std::string trim(const std::string& str);
+    std::vector<std::string> split(const std::string& str, char delimiter);
+    StringView* split(Arena& arena, const StringView& str, char delimiter, size_t& count);
+    std::string toUpper(const std::string& str);
+    std::string toLower(const std::string& str);
+    bool startsWith(const std::string& str, const std::string& prefix);
+    bool endsWith(const std::string& str, const std::string& suffix);
+
+    // IRC specific
+    bool isValidNickname(const std::string& nickname);
+    bool isValidChannelName(const std::string& channelName);
+
+    // RFC 1459 casemapping: A-Z and [\]^ fold into a-z and {|}~
+    char foldCase(char c);
+    size_t hashFolded(const StringView& str);
+    bool equalsFolded(const StringView& a, const StringView& b);
+    std::string getCurrentTimestamp();
+
+    // Mode letters map to bits a-z then A-Z; anything else maps to 0
+    ModeSet modeBit(char mode);
+    ModeSet parseModes(const std::string& modes);
+    std::string formatModes(ModeSet modes);
+    std::string formatMessage(const std::string& prefix, const std::string& command, const std::string& params);
+    std::string formatReply(const std::string& code, const std::string& target, const std::string& message);
+
+    // Network operations
+    void setNonBlocking(int fd);
+    std::string getHostname();
+    std::string getIpAddress(int fd);
+    int getPort(int fd);
+
+    // Error handling
+    void handleError(const std::string& message);
+    void handleSignal(int signal);
+}
+
 #endif // UTILS_HPP 
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "../include/AdminEndpoint.hpp"
+#include "../include/Server.hpp"
+#include "../include/Utils.hpp"
+#include <stdexcept>
+#include <sstream>
+#include <cstdlib>
+#include <errno.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+AdminEndpoint::AdminEndpoint(Server* server, const std::string& endpoint)
+    : _server(server), _listenSocket(-1) {
+    if (!endpoint.empty() && endpoint.find_first_not_of("0123456789") == std::string::npos)
+        listenTcp(std::atoi(endpoint.c_str()));
+    else
+        listenUnix(endpoint);
+
+    Utils::setNonBlocking(_listenSocket);
+    _poller.add(_listenSocket, Poller::READ);
+}
+
+AdminEndpoint::~AdminEndpoint() {
+    while (!_connections.empty())
+        closeConnection(_connections.begin()->first);
+    if (_listenSocket != -1)
+        close(_listenSocket);
+    if (!_path.empty())
+        unlink(_path.c_str());
+}
+
+void AdminEndpoint::listenUnix(const std::string& path) {
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.length() >= sizeof(address.sun_path))
+        throw std::runtime_error("Invalid admin socket path");
+    std::memcpy(address.sun_path, path.c_str(), path.length());
+
+    _listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_listenSocket == -1)
+        throw std::runtime_error("Failed to create admin socket");
+
+    // A socket file left behind by an earlier run would make bind fail
+    unlink(path.c_str());
+    if (bind(_listenSocket, (struct sockaddr*)&address, sizeof(address)) == -1)
+        throw std::runtime_error("Failed to bind admin socket");
+    _path = path;
+    chmod(path.c_str(), S_IRUSR | S_IWUSR);
+
+    if (listen(_listenSocket, ADMIN_MAX_CONNECTIONS) == -1)
+        throw std::runtime_error("Failed to listen on admin socket");
+    _name = "unix:" + path;
+}
+
+void AdminEndpoint::listenTcp(int port) {
+    if (port <= 0 || port > 65535)
+        throw std::runtime_error("Invalid admin port");
+
+    _listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_listenSocket == -1)
+        throw std::runtime_error("Failed to create admin socket");
+
+    int opt = 1;
+    if (setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1)
+        throw std::runtime_error("Failed to set admin socket options");
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (bind(_listenSocket, (struct sockaddr*)&address, sizeof(address)) == -1)
+        throw std::runtime_error("Failed to bind admin socket");
+
+    if (listen(_listenSocket, ADMIN_MAX_CONNECTIONS) == -1)
+        throw std::runtime_error("Failed to listen on admin socket");
+
+    std::ostringstream name;
+    name << "127.0.0.1:" << port;
+    _name = name.str();
+}
+
+// Getters
+const std::string& AdminEndpoint::getName() const { return _name; }
+int AdminEndpoint::getFd() const { return _poller.getFd(); }
+
+// Event handling
+void AdminEndpoint::poll() {
+    if (_poller.wait(_events, 0) <= 0)
+        return;
+
+    for (size_t i = 0; i < _events.size(); ++i) {
+        int fd = _events[i].fd;
+        if (fd == _listenSocket) {
+            acceptConnections();
+            continue;
+        }
+
+        std::map<int, Connection>::iterator it = _connections.find(fd);
+        if (it == _connections.end())
+            continue;
+
+        if (it->second.state == READING)
+            handleRead(fd, it->second);
+        else if (_events[i].events & (Poller::WRITE | Poller::HANGUP))
+            handleWrite(fd, it->second);
+    }
+}
+
+void AdminEndpoint::acceptConnections() {
+    for (;;) {
+        int fd = accept4(_listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1)
+            return;
+
+        if (_connections.size() >= ADMIN_MAX_CONNECTIONS) {
+            close(fd);
+            continue;
+        }
+
+        Connection connection;
+        connection.state = READING;
+        connection.sent = 0;
+        connection.snapshot = NULL;
+        _connections.insert(std::make_pair(fd, connection));
+        _poller.add(fd, Poller::READ);
+    }
+}
+
+// Request line starts with the method and path, optionally followed by a query
+static bool matchesRoute(const std::string& request, const std::string& route) {
+    return request.compare(0, route.length(), route) == 0 && request.length() > route.length()
+           && std::strchr(" ?\r\n", request[route.length()]) != NULL;
+}
+
+static void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (; *text; ++text) {
+        unsigned char c = *text;
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (c < 0x20 || c == 0x7f)
+            out << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 0xf];
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+// One JSON object per line, oldest first; the log is small enough to copy
+// under its own lock, so no slicing is needed
+static std::string renderTrace(const TraceLog& trace) {
+    std::vector<TraceRecord> records;
+    trace.snapshot(records);
+
+    std::ostringstream out;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const TraceRecord& record = records[i];
+        out << "{\"kind\":\"" << (record.kind == TraceRecord::COMMAND ? "command" : "loop")
+            << "\",\"reason\":\"" << (record.reason == TraceRecord::SLOW ? "slow" : "sampled")
+            << "\",\"time_ns\":" << record.time
+            << ",\"duration_ns\":" << record.duration
+            << ",\"bytes\":" << record.bytes;
+        if (record.kind == TraceRecord::COMMAND) {
+            out << ",\"verb\":";
+            writeJsonString(out, record.verb);
+            out << ",\"target\":";
+            writeJsonString(out, record.target);
+            out << ",\"members\":" << record.members;
+        } else {
+            out << ",\"events\":" << record.events;
+        }
+        out << "}\n";
+    }
+    return out.str();
+}
+
+void AdminEndpoint::handleRead(int fd, Connection& connection) {
+    char buffer[1024];
+    ssize_t bytesRead = recv(fd, buffer, sizeof(buffer), 0);
+    if (bytesRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return;
+    if (bytesRead <= 0) {
+        closeConnection(fd);
+        return;
+    }
+
+    std::string& request = connection.request;
+    request.append(buffer, bytesRead);
+    if (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos) {
+        if (request.length() > ADMIN_REQUEST_MAX)
+            respond(fd, connection, "400 Bad Request", "Request too large\n");
+        return;
+    }
+
+    if (matchesRoute(request, "GET /trace")) {
+        respond(fd, connection, "200 OK", renderTrace(_server->getTraceLog()), "application/x-ndjson");
+        return;
+    }
+    if (!matchesRoute(request, "GET /metrics")) {
+        respond(fd, connection, "404 Not Found", "Only GET /metrics and GET /trace are served here\n");
+        return;
+    }
+
+    // The walk runs one slice per event-loop iteration while the socket is writable
+    connection.state = WALKING;
+    connection.snapshot = new MetricsSnapshot(_server);
+    _poller.modify(fd, Poller::WRITE);
+}
+
+void AdminEndpoint::handleWrite(int fd, Connection& connection) {
+    if (connection.state == WALKING) {
+        if (!connection.snapshot->advance())
+            return;
+        respond(fd, connection, "200 OK", connection.snapshot->render());
+        delete connection.snapshot;
+        connection.snapshot = NULL;
+        return;
+    }
+
+    const std::string& response = connection.response;
+    ssize_t sent = send(fd, response.data() + connection.sent, response.length() - connection.sent,
+                        MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            closeConnection(fd);
+        return;
+    }
+
+    connection.sent += sent;
+    if (connection.sent == response.length())
+        closeConnection(fd);
+}
+
+void AdminEndpoint::respond(int fd, Connection& connection, const char* status, const std::string& body,
+                            const char* contentType) {
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: " << contentType << "\r\n"
+             << "Content-Length: " << body.length() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    connection.response = response.str();
+    connection.sent = 0;
+    connection.state = WRITING;
+    _poller.modify(fd, Poller::WRITE);
+}
+
+void AdminEndpoint::closeConnection(int fd) {
+    std::map<int, Connection>::iterator it = _connections.find(fd);
+    if (it == _connections.end())
+        return;
+
+    delete it->second.snapshot;
+    _connections.erase(it);
+    _poller.remove(fd);
+    close(fd);
+}
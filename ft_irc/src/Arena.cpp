@@ -0,0 +1,84 @@
+#include "../include/Arena.hpp"
+#include <cstring>
+#include <new>
+
+Arena::Arena() : _blocks(NULL), _current(NULL), _oversized(NULL), _cursor(NULL), _limit(NULL) {}
+
+Arena::~Arena() {
+    reset();
+    while (_blocks) {
+        Block* next = _blocks->next;
+        ::operator delete(_blocks);
+        _blocks = next;
+    }
+}
+
+Arena::Block* Arena::createBlock(size_t size) {
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = NULL;
+    block->size = size;
+    return block;
+}
+
+void Arena::useBlock(Block* block) {
+    _current = block;
+    _cursor = reinterpret_cast<char*>(block + 1);
+    _limit = _cursor + block->size;
+}
+
+void* Arena::allocate(size_t size) {
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    if (size > ARENA_BLOCK_SIZE) {
+        Block* block = createBlock(size);
+        block->next = _oversized;
+        _oversized = block;
+        return block + 1;
+    }
+
+    if (static_cast<size_t>(_limit - _cursor) < size) {
+        // Move on to the next kept block, or grow the chain by one
+        if (_current && _current->next) {
+            useBlock(_current->next);
+        } else {
+            Block* block = createBlock(ARENA_BLOCK_SIZE);
+            if (_current)
+                _current->next = block;
+            else
+                _blocks = block;
+            useBlock(block);
+        }
+    }
+
+    void* memory = _cursor;
+    _cursor += size;
+    return memory;
+}
+
+void Arena::reset() {
+    while (_oversized) {
+        Block* next = _oversized->next;
+        ::operator delete(_oversized);
+        _oversized = next;
+    }
+    if (_blocks)
+        useBlock(_blocks);
+}
+
+StringView Arena::join(const StringView* parts, size_t count) {
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+        length += parts[i].length;
+
+    char* data = static_cast<char*>(allocate(length));
+    char* pos = data;
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(pos, parts[i].data, parts[i].length);
+        pos += parts[i].length;
+    }
+
+    StringView result;
+    result.data = data;
+    result.length = length;
+    return result;
+}
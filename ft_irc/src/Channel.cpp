@@ -1,112 +1,235 @@
-#include "../include/Channel.hpp"
-#include "../include/Client.hpp"
-#include "../include/Utils.hpp"
-#include <sstream>
-
-Channel::Channel(const std::string& name) : _name(name), _userLimit(0) {
-    _mode = "+n"; // Default mode: no external messages
-}
-
-Channel::~Channel() {
-    // Clean up clients
-    for (std::set<Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        (*it)->removeChannel(this);
-    }
-    _clients.clear();
-    _operators.clear();
-}
-
-// Getters
-const std::string& Channel::getName() const { return _name; }
-const std::string& Channel::getTopic() const { return _topic; }
-const std::string& Channel::getKey() const { return _key; }
-const std::set<Client*>& Channel::getClients() const { return _clients; }
-const std::set<Client*>& Channel::getOperators() const { return _operators; }
-const std::string& Channel::getMode() const { return _mode; }
-size_t Channel::getUserLimit() const { return _userLimit; }
-
-// Setters
-void Channel::setTopic(const std::string& topic) { _topic = topic; }
-void Channel::setKey(const std::string& key) { _key = key; }
-void Channel::setMode(const std::string& mode) { _mode = mode; }
-void Channel::setUserLimit(size_t limit) { _userLimit = limit; }
-
-// Client operations
-void Channel::addClient(Client* client) {
-    if (client) {
-        _clients.insert(client);
-        client->addChannel(this);
-    }
-}
-
-void Channel::removeClient(Client* client) {
-    if (client) {
-        _clients.erase(client);
-        _operators.erase(client);
-        client->removeChannel(this);
-    }
-}
-
-bool Channel::hasClient(Client* client) const {
-    return _clients.find(client) != _clients.end();
-}
-
-bool Channel::isOperator(Client* client) const {
-    return _operators.find(client) != _operators.end();
-}
-
-void Channel::addOperator(Client* client) {
-    if (client && hasClient(client))
-        _operators.insert(client);
-}
-
-void Channel::removeOperator(Client* client) {
-    if (client)
-        _operators.erase(client);
-}
-
-// Mode operations
-bool Channel::hasMode(char mode) const {
-    return _mode.find(mode) != std::string::npos;
-}
-
-void Channel::addMode(char mode) {
-    if (!hasMode(mode))
-        _mode += mode;
-}
-
-void Channel::removeMode(char mode) {
-    size_t pos = _mode.find(mode);
-    if (pos != std::string::npos)
-        _mode.erase(pos, 1);
-}
-
-// Channel operations
-void Channel::broadcast(const std::string& message, Client* sender) {
-    std::string prefix;
-    if (sender)
-        prefix = sender->getNickname() + "!" + sender->getUsername() + "@" + sender->getHostname();
-
-    for (std::set<Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        if (*it != sender) {
-            std::string fullMessage = ":" + prefix + " " + message + "\r\n";
-            send((*it)->getFd(), fullMessage.c_str(), fullMessage.length(), 0);
-        }
-    }
-}
-
-bool Channel::isInviteOnly() const {
-    return hasMode('i');
-}
-
-bool Channel::isModerated() const {
-    return hasMode('m');
-}
-
-bool Channel::isSecret() const {
-    return hasMode('s');
-}
-
-bool Channel::isProtected() const {
-    return hasMode('p');
+#include "../include/Channel.hpp"
+#include "../include/Client.hpp"
+#include "../include/Utils.hpp"
+#include <sstream>
+
+Channel::Channel(const std::string& name) : _name(name), _userLimit(0), _namesStale(false) {
+    _modes = Utils::modeBit('n'); // Default mode: no external messages
+}
+
+Channel::~Channel() {
+    // Clean up clients
+    for (size_t i = 0; i < _members.size(); ++i) {
+        _members[i].client->removeChannel(this);
+    }
+    _members.clear();
+    _memberIndex.clear();
+    clearNames();
+}
+
+void* Channel::operator new(size_t size) {
+    return getPool().allocate(size);
+}
+
+void Channel::operator delete(void* object) {
+    getPool().release(object);
+}
+
+ObjectPool& Channel::getPool() {
+    static ObjectPool* pool = new ObjectPool("channel", sizeof(Channel));
+    return *pool;
+}
+
+// Getters
+const std::string& Channel::getName() const { return _name; }
+const std::string& Channel::getTopic() const { return _topic; }
+const std::string& Channel::getKey() const { return _key; }
+const std::vector<Channel::Member>& Channel::getMembers() const { return _members; }
+size_t Channel::size() const { return _members.size(); }
+bool Channel::empty() const { return _members.empty(); }
+std::string Channel::getMode() const { return Utils::formatModes(_modes); }
+size_t Channel::getUserLimit() const { return _userLimit; }
+
+// Setters
+void Channel::setTopic(const std::string& topic) { _topic = topic; }
+void Channel::setKey(const std::string& key) { _key = key; }
+void Channel::setMode(const std::string& mode) { _modes = Utils::parseModes(mode); }
+void Channel::setUserLimit(size_t limit) { _userLimit = limit; }
+
+// Client operations
+Channel::Member* Channel::findMember(Client* client) {
+    if (!client)
+        return NULL;
+    MemberIndex::iterator it = _memberIndex.find(client->getFd());
+    return it != _memberIndex.end() && _members[it->second].client == client ? &_members[it->second] : NULL;
+}
+
+const Channel::Member* Channel::findMember(Client* client) const {
+    if (!client)
+        return NULL;
+    MemberIndex::const_iterator it = _memberIndex.find(client->getFd());
+    return it != _memberIndex.end() && _members[it->second].client == client ? &_members[it->second] : NULL;
+}
+
+void Channel::addClient(Client* client) {
+    if (client && !hasClient(client)) {
+        Member member;
+        member.client = client;
+        member.status = 0;
+        _memberIndex[client->getFd()] = _members.size();
+        _members.push_back(member);
+        client->addChannel(this);
+        appendName(member);
+    }
+}
+
+void Channel::removeClient(Client* client) {
+    if (!client)
+        return;
+
+    MemberIndex::iterator it = _memberIndex.find(client->getFd());
+    if (it != _memberIndex.end() && _members[it->second].client == client) {
+        size_t slot = it->second;
+        _memberIndex.erase(it);
+        if (slot != _members.size() - 1) {
+            _members[slot] = _members.back();
+            _memberIndex[_members[slot].client->getFd()] = slot;
+        }
+        _members.pop_back();
+        invalidateNames();
+    }
+    client->removeChannel(this);
+}
+
+bool Channel::hasClient(Client* client) const {
+    return findMember(client) != NULL;
+}
+
+bool Channel::hasStatus(Client* client, unsigned char status) const {
+    const Member* member = findMember(client);
+    return member && (member->status & status);
+}
+
+void Channel::setStatus(Client* client, unsigned char status, bool enabled) {
+    Member* member = findMember(client);
+    if (!member)
+        return;
+    unsigned char previous = member->status;
+    if (enabled)
+        member->status |= status;
+    else
+        member->status &= ~status;
+    if (member->status != previous)
+        invalidateNames();
+}
+
+bool Channel::isOperator(Client* client) const {
+    return hasStatus(client, MEMBER_OPERATOR);
+}
+
+void Channel::addOperator(Client* client) {
+    setStatus(client, MEMBER_OPERATOR, true);
+}
+
+void Channel::removeOperator(Client* client) {
+    setStatus(client, MEMBER_OPERATOR, false);
+}
+
+// Mode operations
+bool Channel::hasMode(char mode) const {
+    return (_modes & Utils::modeBit(mode)) != 0;
+}
+
+void Channel::addMode(char mode) {
+    _modes |= Utils::modeBit(mode);
+}
+
+void Channel::removeMode(char mode) {
+    _modes &= ~Utils::modeBit(mode);
+}
+
+// Channel operations
+void Channel::broadcast(const std::string& line, Client* except) {
+    broadcast(StringView::from(line), except);
+}
+
+void Channel::broadcast(const StringView& line, Client* except) {
+    // Serialize once; every recipient queues a reference to the same buffer
+    SharedBuffer* buffer = SharedBuffer::create(line);
+    for (size_t i = 0; i < _members.size(); ++i) {
+        if (_members[i].client != except)
+            _members[i].client->sendMessage(buffer);
+    }
+    buffer->release();
+}
+
+// NAMES
+void Channel::sendNames(Client* client) {
+    if (_namesStale)
+        rebuildNames();
+
+    // Only chunks changed since the last request are serialized again
+    for (size_t i = 0; i < _names.size(); ++i) {
+        if (!_namesLines[i])
+            _namesLines[i] = SharedBuffer::create(Utils::formatMessage(SERVER_NAME, RPL_NAMREPLY(_name, _names[i]), ""));
+        client->sendMessage(_namesLines[i]);
+    }
+    client->sendMessage(Utils::formatMessage(SERVER_NAME, RPL_ENDOFNAMES(_name), ""));
+}
+
+void Channel::invalidateNames() {
+    _namesStale = true;
+}
+
+void Channel::appendName(const Member& member) {
+    if (_namesStale)
+        return;
+
+    std::string token;
+    if (member.status & MEMBER_OPERATOR)
+        token = "@";
+    else if (member.status & MEMBER_VOICE)
+        token = "+";
+    token += member.client->getNickname();
+
+    // ":" SERVER_NAME " 353 " channel " :" names CRLF stays within one line
+    size_t overhead = std::string(SERVER_NAME).length() + _name.length() + 10;
+    size_t budget = MAX_LINE_LENGTH > overhead ? MAX_LINE_LENGTH - overhead : 0;
+
+    if (_names.empty() || _names.back().length() + 1 + token.length() > budget) {
+        _names.push_back(token);
+        _namesLines.push_back(NULL);
+        return;
+    }
+    _names.back().append(" ").append(token);
+    if (_namesLines.back()) {
+        _namesLines.back()->release();
+        _namesLines.back() = NULL;
+    }
+}
+
+void Channel::rebuildNames() {
+    clearNames();
+    _namesStale = false;
+    for (size_t i = 0; i < _members.size(); ++i)
+        appendName(_members[i]);
+}
+
+void Channel::clearNames() {
+    for (size_t i = 0; i < _namesLines.size(); ++i) {
+        if (_namesLines[i])
+            _namesLines[i]->release();
+    }
+    _namesLines.clear();
+    _names.clear();
+}
+
+bool Channel::isInviteOnly() const {
+    return hasMode('i');
+}
+
+bool Channel::isModerated() const {
+    return hasMode('m');
+}
+
+bool Channel::isSecret() const {
+    return hasMode('s');
+}
+
+bool Channel::isProtected() const {
+    return hasMode('p');
+}
+
+bool Channel::isPersistent() const {
+    return hasMode('P');
 } 
\ No newline at end of file
@@ -1,95 +1,195 @@
-#include "../include/Client.hpp"
-#include "../include/Channel.hpp"
-#include "../include/Utils.hpp"
-#include <sstream>
-
-Client::Client(int fd) : _fd(fd), _registered(false), _authenticated(false), _mode("") {
-    _hostname = Utils::getIpAddress(fd);
-}
-
-Client::~Client() {
-    // Clean up channels
-    for (std::set<Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it) {
-        (*it)->removeClient(this);
-    }
-    _channels.clear();
-}
-
-// Getters
-int Client::getFd() const { return _fd; }
-const std::string& Client::getNickname() const { return _nickname; }
-const std::string& Client::getUsername() const { return _username; }
-const std::string& Client::getRealname() const { return _realname; }
-const std::string& Client::getHostname() const { return _hostname; }
-const std::string& Client::getBuffer() const { return _buffer; }
-bool Client::isRegistered() const { return _registered; }
-bool Client::isAuthenticated() const { return _authenticated; }
-const std::set<Channel*>& Client::getChannels() const { return _channels; }
-const std::string& Client::getMode() const { return _mode; }
-
-// Setters
-void Client::setNickname(const std::string& nickname) { _nickname = nickname; }
-void Client::setUsername(const std::string& username) { _username = username; }
-void Client::setRealname(const std::string& realname) { _realname = realname; }
-void Client::setHostname(const std::string& hostname) { _hostname = hostname; }
-void Client::setRegistered(bool registered) { _registered = registered; }
-void Client::setAuthenticated(bool authenticated) { _authenticated = authenticated; }
-void Client::setMode(const std::string& mode) { _mode = mode; }
-
-// Channel operations
-void Client::addChannel(Channel* channel) {
-    if (channel)
-        _channels.insert(channel);
-}
-
-void Client::removeChannel(Channel* channel) {
-    if (channel)
-        _channels.erase(channel);
-}
-
-bool Client::isInChannel(const std::string& channelName) const {
-    for (std::set<Channel*>::const_iterator it = _channels.begin(); it != _channels.end(); ++it) {
-        if ((*it)->getName() == channelName)
-            return true;
-    }
-    return false;
-}
-
-// Buffer operations
-void Client::appendToBuffer(const std::string& data) {
-    _buffer += data;
-}
-
-void Client::clearBuffer() {
-    _buffer.clear();
-}
-
-bool Client::hasCompleteCommand() const {
-    return _buffer.find("\r\n") != std::string::npos;
-}
-
-std::string Client::getNextCommand() {
-    size_t pos = _buffer.find("\r\n");
-    if (pos == std::string::npos)
-        return "";
-
-    std::string command = _buffer.substr(0, pos);
-    _buffer = _buffer.substr(pos + 2);
-    return command;
-}
-
-// Mode operations
-bool Client::hasMode(char mode) const {
-    return _mode.find(mode) != std::string::npos;
-}
-
-void Client::addMode(char mode) {
-    if (!hasMode(mode))
-        _mode += mode;
-}
-
-void Client::removeMode(char mode) {
-    size_t pos = _mode.find(mode);
-    if (pos != std::string::npos)
-        _mode.erase(pos, 1);
+#include "../include/Client.hpp"
+#include "../include/Channel.hpp"
+#include "../include/Reactor.hpp"
+#include "../include/Utils.hpp"
+#include "../include/Stats.hpp"
+#include <sstream>
+
+Client::Client(int fd, Reactor* reactor, in_addr_t address)
+    : _fd(fd), _registered(false), _authenticated(false), _modes(0), _writeWatched(false), _reactor(reactor),
+      _address(address), _epoch(0) {
+    // The peer address accept() reported; the socket's own name only when none was given
+    if (address != INADDR_ANY) {
+        struct in_addr peer;
+        peer.s_addr = address;
+        _hostname = InternedString(inet_ntoa(peer));
+    } else {
+        _hostname = InternedString(Utils::getIpAddress(fd));
+    }
+    updateSource();
+}
+
+Client::~Client() {
+    // Clean up channels; removeClient erases the entry from _channels
+    while (!_channels.empty())
+        (*_channels.begin())->removeClient(this);
+}
+
+void* Client::operator new(size_t size) {
+    return getPool().allocate(size);
+}
+
+void Client::operator delete(void* object) {
+    getPool().release(object);
+}
+
+ObjectPool& Client::getPool() {
+    // Never destroyed: reactor threads may still free clients during exit
+    static ObjectPool* pool = new ObjectPool("client", sizeof(Client));
+    return *pool;
+}
+
+// Getters
+int Client::getFd() const { return _fd; }
+const std::string& Client::getNickname() const { return _nickname.str(); }
+const InternedString& Client::getNicknameHandle() const { return _nickname; }
+const std::string& Client::getUsername() const { return _username.str(); }
+const std::string& Client::getRealname() const { return _realname.str(); }
+const std::string& Client::getHostname() const { return _hostname.str(); }
+const std::string& Client::getSource() const { return _source; }
+bool Client::isRegistered() const { return _registered; }
+bool Client::isAuthenticated() const { return _authenticated; }
+const std::set<Channel*>& Client::getChannels() const { return _channels; }
+std::string Client::getMode() const { return Utils::formatModes(_modes); }
+Reactor* Client::getReactor() const { return _reactor; }
+in_addr_t Client::getAddress() const { return _address; }
+
+// Setters
+void Client::setNickname(const std::string& nickname) { _nickname = InternedString(nickname); updateSource(); }
+void Client::setUsername(const std::string& username) { _username = InternedString(username); updateSource(); }
+void Client::setRealname(const std::string& realname) { _realname = InternedString(realname); }
+void Client::setHostname(const std::string& hostname) { _hostname = InternedString(hostname); updateSource(); }
+void Client::setRegistered(bool registered) { _registered = registered; }
+void Client::setAuthenticated(bool authenticated) { _authenticated = authenticated; }
+void Client::setMode(const std::string& mode) { _modes = Utils::parseModes(mode); }
+
+// Serialized ":nick!user@host" prefix for messages this client originates
+void Client::updateSource() {
+    _source = ":" + _nickname.str();
+    if (!_username.empty())
+        _source += "!" + _username.str() + "@" + _hostname.str();
+}
+
+// Channel operations
+void Client::addChannel(Channel* channel) {
+    if (channel)
+        _channels.insert(channel);
+}
+
+void Client::removeChannel(Channel* channel) {
+    if (channel)
+        _channels.erase(channel);
+}
+
+bool Client::isInChannel(const std::string& channelName) const {
+    for (std::set<Channel*>::const_iterator it = _channels.begin(); it != _channels.end(); ++it) {
+        if ((*it)->getName() == channelName)
+            return true;
+    }
+    return false;
+}
+
+// Input operations
+InputBuffer& Client::getInput() {
+    return _input;
+}
+
+// Output operations
+// Output is charged to the reactor whose thread produced it, once, even
+// when the recipient belongs to another reactor
+static void chargeOutput(size_t bytes) {
+    Reactor* producer = Reactor::getCurrent();
+    if (producer)
+        producer->getStats().add(Stats::BYTES_QUEUED, bytes);
+}
+
+void Client::sendMessage(const std::string& message) {
+    chargeOutput(message.length());
+
+    // Another reactor owns this client: hand the bytes over to its thread
+    if (_reactor && !_reactor->isCurrentThread()) {
+        SharedBuffer* buffer = SharedBuffer::create(message);
+        _reactor->post(this, buffer);
+        buffer->release();
+        return;
+    }
+
+    SharedBuffer* buffer = SharedBuffer::create(message);
+    deliver(buffer);
+    buffer->release();
+}
+
+void Client::sendMessage(const StringView& message) {
+    if (message.empty())
+        return;
+    SharedBuffer* buffer = SharedBuffer::create(message);
+    sendMessage(buffer);
+    buffer->release();
+}
+
+void Client::sendMessage(const SharedBuffer* message) {
+    chargeOutput(message->length());
+
+    if (_reactor && !_reactor->isCurrentThread()) {
+        _reactor->post(this, message);
+        return;
+    }
+    deliver(message);
+}
+
+void Client::deliver(const SharedBuffer* message) {
+    bool wasEmpty = _output.empty();
+    bool wasOverflowed = _output.isOverflowed();
+    bool queued = _output.push(message);
+
+    // Put the client on the reactor's flush list on the empty -> pending
+    // transition, and once more when the queue overflows so it gets dropped
+    if (_reactor && (queued ? wasEmpty && !_output.empty() : !wasOverflowed))
+        _reactor->scheduleWrite(this);
+    if (_reactor && _output.size() > EARLY_FLUSH_BYTES)
+        _reactor->requestEarlyFlush();
+}
+
+bool Client::hasPendingOutput() const {
+    return !_output.empty();
+}
+
+size_t Client::getPendingOutput() const {
+    return _output.size();
+}
+
+OutputQueue& Client::getOutputQueue() {
+    return _output;
+}
+
+ssize_t Client::flushOutput() {
+    return _output.flush(_fd);
+}
+
+bool Client::isWriteWatched() const {
+    return _writeWatched;
+}
+
+void Client::setWriteWatched(bool watched) {
+    _writeWatched = watched;
+}
+
+bool Client::stampEpoch(unsigned long epoch) {
+    if (_epoch == epoch)
+        return false;
+    _epoch = epoch;
+    return true;
+}
+
+// Mode operations
+bool Client::hasMode(char mode) const {
+    return (_modes & Utils::modeBit(mode)) != 0;
+}
+
+void Client::addMode(char mode) {
+    _modes |= Utils::modeBit(mode);
+}
+
+void Client::removeMode(char mode) {
+    _modes &= ~Utils::modeBit(mode);
 } 
\ No newline at end of file
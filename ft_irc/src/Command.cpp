@@ -1,553 +1,822 @@
-#include "../include/Command.hpp"
-#include "../include/Client.hpp"
-#include "../include/Server.hpp"
-#include "../include/Utils.hpp"
-#include <sstream>
-
-Command::Command(const std::string& rawCommand, Client* client, Server* server)
-    : _client(client), _server(server) {
-    std::vector<std::string> parts = parseCommand(rawCommand);
-    if (!parts.empty()) {
-        _name = Utils::toUpper(parts[0]);
-        _args.assign(parts.begin() + 1, parts.end());
-    }
-}
-
-Command::~Command() {}
-
-// Getters
-const std::string& Command::getName() const { return _name; }
-const std::vector<std::string>& Command::getArgs() const { return _args; }
-Client* Command::getClient() const { return _client; }
-Server* Command::getServer() const { return _server; }
-
-// Command parsing
-std::vector<std::string> Command::parseCommand(const std::string& rawCommand) {
-    std::vector<std::string> tokens;
-    std::string token;
-    std::istringstream tokenStream(rawCommand);
-    
-    while (std::getline(tokenStream, token, ' ')) {
-        token = Utils::trim(token);
-        if (!token.empty())
-            tokens.push_back(token);
-    }
-    
-    return tokens;
-}
-
-bool Command::isValidNickname(const std::string& nickname) {
-    return Utils::isValidNickname(nickname);
-}
-
-bool Command::isValidChannelName(const std::string& channelName) {
-    return Utils::isValidChannelName(channelName);
-}
-
-// Command execution
-void Command::execute() {
-    if (_name == "PASS") executePass();
-    else if (_name == "NICK") executeNick();
-    else if (_name == "USER") executeUser();
-    else if (_name == "QUIT") executeQuit();
-    else if (_name == "JOIN") executeJoin();
-    else if (_name == "PART") executePart();
-    else if (_name == "PRIVMSG") executePrivmsg();
-    else if (_name == "NOTICE") executeNotice();
-    else if (_name == "KICK") executeKick();
-    else if (_name == "INVITE") executeInvite();
-    else if (_name == "TOPIC") executeTopic();
-    else if (_name == "MODE") executeMode();
-    else if (_name == "PING") executePing();
-    else if (_name == "PONG") executePong();
-    else {
-        std::string error = ERR_UNKNOWNCOMMAND(_name);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-    }
-}
-
-void Command::executePass() {
-    if (_client->isAuthenticated()) {
-        std::string error = ERR_ALREADYREGISTERED;
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (_args.empty()) {
-        std::string error = ERR_NEEDMOREPARAMS("PASS");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (_args[0] == _server->getPassword()) {
-        _client->setAuthenticated(true);
-    } else {
-        std::string error = ERR_PASSWDMISMATCH;
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-    }
-}
-
-void Command::executeNick() {
-    if (_args.empty()) {
-        std::string error = ERR_NONICKNAMEGIVEN;
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::string newNick = _args[0];
-    if (!isValidNickname(newNick)) {
-        std::string error = ERR_ERRONEUSNICKNAME(newNick);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (_server->isNicknameInUse(newNick)) {
-        std::string error = ERR_NICKNAMEINUSE(newNick);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::string oldNick = _client->getNickname();
-    _client->setNickname(newNick);
-
-    if (!oldNick.empty()) {
-        std::string message = ":" + oldNick + " NICK " + newNick + "\r\n";
-        _server->broadcastToAll(message, _client);
-    }
-}
-
-void Command::executeUser() {
-    if (_client->isRegistered()) {
-        std::string error = ERR_ALREADYREGISTERED;
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (_args.size() < 4) {
-        std::string error = ERR_NEEDMOREPARAMS("USER");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    _client->setUsername(_args[0]);
-    _client->setRealname(_args[3]);
-    _client->setRegistered(true);
-
-    // Send welcome messages
-    std::string welcome = RPL_WELCOME(_client->getNickname());
-    std::string yourHost = RPL_YOURHOST(SERVER_NAME, SERVER_VERSION);
-    std::string created = RPL_CREATED(Utils::getCurrentTimestamp());
-    std::string myInfo = RPL_MYINFO(SERVER_NAME, SERVER_VERSION, "aiwro", "Oov");
-
-    send(_client->getFd(), welcome.c_str(), welcome.length(), 0);
-    send(_client->getFd(), yourHost.c_str(), yourHost.length(), 0);
-    send(_client->getFd(), created.c_str(), created.length(), 0);
-    send(_client->getFd(), myInfo.c_str(), myInfo.length(), 0);
-}
-
-void Command::executeQuit() {
-    std::string message = "QUIT";
-    if (!_args.empty())
-        message += " :" + _args[0];
-    message += "\r\n";
-
-    _server->broadcastToAll(message, _client);
-    _server->removeClient(_client);
-}
-
-void Command::executeJoin() {
-    if (_args.empty()) {
-        std::string error = ERR_NEEDMOREPARAMS("JOIN");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::vector<std::string> channels = Utils::split(_args[0], ',');
-    std::vector<std::string> keys = _args.size() > 1 ? Utils::split(_args[1], ',') : std::vector<std::string>();
-
-    for (size_t i = 0; i < channels.size(); ++i) {
-        std::string channelName = channels[i];
-        if (!isValidChannelName(channelName)) {
-            continue;
-        }
-
-        Channel* channel = _server->getChannel(channelName);
-        if (!channel) {
-            channel = _server->createChannel(channelName);
-        }
-
-        if (channel->isInviteOnly() && !channel->isOperator(_client)) {
-            std::string error = ERR_INVITEONLYCHAN(channelName);
-            send(_client->getFd(), error.c_str(), error.length(), 0);
-            continue;
-        }
-
-        if (!channel->getKey().empty() && (i >= keys.size() || keys[i] != channel->getKey())) {
-            std::string error = ERR_BADCHANNELKEY(channelName);
-            send(_client->getFd(), error.c_str(), error.length(), 0);
-            continue;
-        }
-
-        if (channel->getUserLimit() > 0 && channel->getClients().size() >= channel->getUserLimit()) {
-            std::string error = ERR_CHANNELISFULL(channelName);
-            send(_client->getFd(), error.c_str(), error.length(), 0);
-            continue;
-        }
-
-        channel->addClient(_client);
-        if (channel->getClients().size() == 1) {
-            channel->addOperator(_client);
-        }
-
-        std::string joinMessage = ":" + _client->getNickname() + " JOIN " + channelName + "\r\n";
-        channel->broadcast(joinMessage);
-
-        // Send channel info
-        std::string topic = channel->getTopic().empty() ? RPL_NOTOPIC(channelName) : RPL_TOPIC(channelName, channel->getTopic());
-        send(_client->getFd(), topic.c_str(), topic.length(), 0);
-
-        std::string names;
-        for (std::set<Client*>::const_iterator it = channel->getClients().begin(); it != channel->getClients().end(); ++it) {
-            if (it != channel->getClients().begin())
-                names += " ";
-            if (channel->isOperator(*it))
-                names += "@";
-            names += (*it)->getNickname();
-        }
-        std::string namesReply = RPL_NAMREPLY(channelName, names);
-        std::string endNames = RPL_ENDOFNAMES(channelName);
-        send(_client->getFd(), namesReply.c_str(), namesReply.length(), 0);
-        send(_client->getFd(), endNames.c_str(), endNames.length(), 0);
-    }
-}
-
-void Command::executePart() {
-    if (_args.empty()) {
-        std::string error = ERR_NEEDMOREPARAMS("PART");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::vector<std::string> channels = Utils::split(_args[0], ',');
-    std::string reason = _args.size() > 1 ? _args[1] : "";
-
-    for (size_t i = 0; i < channels.size(); ++i) {
-        Channel* channel = _server->getChannel(channels[i]);
-        if (!channel) {
-            std::string error = ERR_NOSUCHCHANNEL(channels[i]);
-            send(_client->getFd(), error.c_str(), error.length(), 0);
-            continue;
-        }
-
-        if (!channel->hasClient(_client)) {
-            std::string error = ERR_NOTONCHANNEL(channels[i]);
-            send(_client->getFd(), error.c_str(), error.length(), 0);
-            continue;
-        }
-
-        std::string partMessage = ":" + _client->getNickname() + " PART " + channels[i];
-        if (!reason.empty())
-            partMessage += " :" + reason;
-        partMessage += "\r\n";
-
-        channel->broadcast(partMessage);
-        channel->removeClient(_client);
-    }
-}
-
-void Command::executePrivmsg() {
-    if (_args.empty()) {
-        std::string error = ERR_NORECIPIENT("PRIVMSG");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (_args.size() < 2) {
-        std::string error = ERR_NOTEXTTOSEND;
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::vector<std::string> targets = Utils::split(_args[0], ',');
-    std::string message = _args[1];
-
-    for (size_t i = 0; i < targets.size(); ++i) {
-        if (targets[i][0] == '#' || targets[i][0] == '&') {
-            Channel* channel = _server->getChannel(targets[i]);
-            if (!channel) {
-                std::string error = ERR_NOSUCHCHANNEL(targets[i]);
-                send(_client->getFd(), error.c_str(), error.length(), 0);
-                continue;
-            }
-
-            if (!channel->hasClient(_client)) {
-                std::string error = ERR_CANNOTSENDTOCHAN(targets[i]);
-                send(_client->getFd(), error.c_str(), error.length(), 0);
-                continue;
-            }
-
-            channel->broadcast("PRIVMSG " + targets[i] + " :" + message, _client);
-        } else {
-            Client* target = _server->getClient(targets[i]);
-            if (!target) {
-                std::string error = ERR_NOSUCHNICK(targets[i]);
-                send(_client->getFd(), error.c_str(), error.length(), 0);
-                continue;
-            }
-
-            std::string privmsg = ":" + _client->getNickname() + " PRIVMSG " + targets[i] + " :" + message + "\r\n";
-            send(target->getFd(), privmsg.c_str(), privmsg.length(), 0);
-        }
-    }
-}
-
-void Command::executeNotice() {
-    // Similar to PRIVMSG but without error replies
-    if (_args.size() < 2)
-        return;
-
-    std::vector<std::string> targets = Utils::split(_args[0], ',');
-    std::string message = _args[1];
-
-    for (size_t i = 0; i < targets.size(); ++i) {
-        if (targets[i][0] == '#' || targets[i][0] == '&') {
-            Channel* channel = _server->getChannel(targets[i]);
-            if (channel && channel->hasClient(_client)) {
-                channel->broadcast("NOTICE " + targets[i] + " :" + message, _client);
-            }
-        } else {
-            Client* target = _server->getClient(targets[i]);
-            if (target) {
-                std::string notice = ":" + _client->getNickname() + " NOTICE " + targets[i] + " :" + message + "\r\n";
-                send(target->getFd(), notice.c_str(), notice.length(), 0);
-            }
-        }
-    }
-}
-
-void Command::executeKick() {
-    if (_args.size() < 2) {
-        std::string error = ERR_NEEDMOREPARAMS("KICK");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    Channel* channel = _server->getChannel(_args[0]);
-    if (!channel) {
-        std::string error = ERR_NOSUCHCHANNEL(_args[0]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (!channel->isOperator(_client)) {
-        std::string error = ERR_CHANOPRIVSNEEDED(_args[0]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    Client* target = _server->getClient(_args[1]);
-    if (!target || !channel->hasClient(target)) {
-        std::string error = ERR_NOTONCHANNEL(_args[0]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::string reason = _args.size() > 2 ? _args[2] : _client->getNickname();
-    std::string kickMessage = ":" + _client->getNickname() + " KICK " + _args[0] + " " + _args[1] + " :" + reason + "\r\n";
-    channel->broadcast(kickMessage);
-    channel->removeClient(target);
-}
-
-void Command::executeInvite() {
-    if (_args.size() < 2) {
-        std::string error = ERR_NEEDMOREPARAMS("INVITE");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    Client* target = _server->getClient(_args[0]);
-    if (!target) {
-        std::string error = ERR_NOSUCHNICK(_args[0]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    Channel* channel = _server->getChannel(_args[1]);
-    if (!channel) {
-        std::string error = ERR_NOSUCHCHANNEL(_args[1]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (!channel->isOperator(_client)) {
-        std::string error = ERR_CHANOPRIVSNEEDED(_args[1]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (channel->hasClient(target)) {
-        std::string error = "443 " + _args[0] + " " + _args[1] + " :is already on channel";
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::string inviteMessage = ":" + _client->getNickname() + " INVITE " + _args[0] + " " + _args[1] + "\r\n";
-    send(target->getFd(), inviteMessage.c_str(), inviteMessage.length(), 0);
-}
-
-void Command::executeTopic() {
-    if (_args.empty()) {
-        std::string error = ERR_NEEDMOREPARAMS("TOPIC");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    Channel* channel = _server->getChannel(_args[0]);
-    if (!channel) {
-        std::string error = ERR_NOSUCHCHANNEL(_args[0]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (!channel->hasClient(_client)) {
-        std::string error = ERR_NOTONCHANNEL(_args[0]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (_args.size() == 1) {
-        std::string reply = channel->getTopic().empty() ? 
-            RPL_NOTOPIC(_args[0]) : RPL_TOPIC(_args[0], channel->getTopic());
-        send(_client->getFd(), reply.c_str(), reply.length(), 0);
-        return;
-    }
-
-    if (channel->hasMode('t') && !channel->isOperator(_client)) {
-        std::string error = ERR_CHANOPRIVSNEEDED(_args[0]);
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    std::string newTopic = _args[1];
-    channel->setTopic(newTopic);
-
-    std::string topicMessage = ":" + _client->getNickname() + " TOPIC " + _args[0] + " :" + newTopic + "\r\n";
-    channel->broadcast(topicMessage);
-}
-
-void Command::executeMode() {
-    if (_args.empty()) {
-        std::string error = ERR_NEEDMOREPARAMS("MODE");
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-        return;
-    }
-
-    if (_args[0][0] == '#' || _args[0][0] == '&') {
-        Channel* channel = _server->getChannel(_args[0]);
-        if (!channel) {
-            std::string error = ERR_NOSUCHCHANNEL(_args[0]);
-            send(_client->getFd(), error.c_str(), error.length(), 0);
-            return;
-        }
-
-        if (!channel->isOperator(_client)) {
-            std::string error = ERR_CHANOPRIVSNEEDED(_args[0]);
-            send(_client->getFd(), error.c_str(), error.length(), 0);
-            return;
-        }
-
-        if (_args.size() == 1) {
-            std::string modeReply = RPL_CHANNELMODEIS(_args[0], channel->getMode());
-            send(_client->getFd(), modeReply.c_str(), modeReply.length(), 0);
-            return;
-        }
-
-        std::string modes = _args[1];
-        bool adding = true;
-        std::string modeChanges;
-
-        for (size_t i = 0; i < modes.length(); ++i) {
-            if (modes[i] == '+')
-                adding = true;
-            else if (modes[i] == '-')
-                adding = false;
-            else {
-                switch (modes[i]) {
-                    case 'i':
-                        if (adding)
-                            channel->addMode('i');
-                        else
-                            channel->removeMode('i');
-                        modeChanges += (adding ? "+" : "-") + std::string(1, modes[i]);
-                        break;
-                    case 't':
-                        if (adding)
-                            channel->addMode('t');
-                        else
-                            channel->removeMode('t');
-                        modeChanges += (adding ? "+" : "-") + std::string(1, modes[i]);
-                        break;
-                    case 'k':
-                        if (adding) {
-                            if (i + 1 < modes.length()) {
-                                channel->setKey(modes.substr(i + 1));
-                                modeChanges += "+k " + modes.substr(i + 1);
-                                i++;
-                            }
-                        } else {
-                            channel->setKey("");
-                            modeChanges += "-k";
-                        }
-                        break;
-                    case 'o':
-                        if (i + 1 < modes.length()) {
-                            Client* target = _server->getClient(modes.substr(i + 1));
-                            if (target) {
-                                if (adding)
-                                    channel->addOperator(target);
-                                else
-                                    channel->removeOperator(target);
-                                modeChanges += (adding ? "+" : "-") + std::string(1, modes[i]) + " " + target->getNickname();
-                            }
-                            i++;
-                        }
-                        break;
-                    case 'l':
-                        if (adding) {
-                            if (i + 1 < modes.length()) {
-                                size_t limit = std::atoi(modes.substr(i + 1).c_str());
-                                channel->setUserLimit(limit);
-                                modeChanges += "+l " + modes.substr(i + 1);
-                                i++;
-                            }
-                        } else {
-                            channel->setUserLimit(0);
-                            modeChanges += "-l";
-                        }
-                        break;
-                }
-            }
-        }
-
-        if (!modeChanges.empty()) {
-            std::string modeMessage = ":" + _client->getNickname() + " MODE " + _args[0] + " " + modeChanges + "\r\n";
-            channel->broadcast(modeMessage);
-        }
-    } else {
-        // User modes (not implemented in this basic version)
-        std::string error = ERR_USERSDONTMATCH;
-        send(_client->getFd(), error.c_str(), error.length(), 0);
-    }
-}
-
-void Command::executePing() {
-    if (_args.empty())
-        return;
-
-    std::string pong = "PONG " + SERVER_NAME + " :" + _args[0] + "\r\n";
-    send(_client->getFd(), pong.c_str(), pong.length(), 0);
-}
-
-void Command::executePong() {
-    // PONG is just acknowledged, no response needed
-} 
\ No newline at end of file
+#include "../include/Command.hpp"
+#include "../include/Client.hpp"
+#include "../include/Server.hpp"
+#include "../include/Utils.hpp"
+#include "../include/Stats.hpp"
+#include "../include/ObjectPool.hpp"
+#include "../include/InternedString.hpp"
+#include <cstdlib>
+#include <cctype>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+
+// Indexed by lookup(); NICK, PRIVMSG, NOTICE and PING keep minParams at 0
+// because they answer a missing parameter with their own reply
+enum CommandId {
+    CMD_PASS, CMD_NICK, CMD_USER, CMD_QUIT, CMD_JOIN, CMD_PART, CMD_PRIVMSG,
+    CMD_NOTICE, CMD_KICK, CMD_INVITE, CMD_TOPIC, CMD_MODE, CMD_PING, CMD_PONG,
+    CMD_NAMES, CMD_OPER, CMD_STATS
+};
+
+static const Command::Spec COMMANDS[] = {
+    // name      handler                     params  registered  shared
+    { "PASS",    &Command::executePass,      1,      false,      false },
+    { "NICK",    &Command::executeNick,      0,      false,      false },
+    { "USER",    &Command::executeUser,      4,      false,      false },
+    { "QUIT",    &Command::executeQuit,      0,      false,      false },
+    { "JOIN",    &Command::executeJoin,      1,      true,       false },
+    { "PART",    &Command::executePart,      1,      true,       false },
+    { "PRIVMSG", &Command::executePrivmsg,   0,      true,       true  },
+    { "NOTICE",  &Command::executeNotice,    0,      true,       true  },
+    { "KICK",    &Command::executeKick,      2,      true,       false },
+    { "INVITE",  &Command::executeInvite,    2,      true,       false },
+    { "TOPIC",   &Command::executeTopic,     1,      true,       false },
+    { "MODE",    &Command::executeMode,      1,      true,       false },
+    { "PING",    &Command::executePing,      0,      false,      true  },
+    { "PONG",    &Command::executePong,      0,      false,      true  },
+    { "NAMES",   &Command::executeNames,     0,      true,       false },
+    { "OPER",    &Command::executeOper,      2,      true,       false },
+    { "STATS",   &Command::executeStats,     1,      true,       false }
+};
+
+#define REGISTRY_SIZE (sizeof(COMMANDS) / sizeof(COMMANDS[0]))
+
+// Every verb needs its own Stats slot besides the one for unknown verbs
+typedef char RegistryFitsStats[REGISTRY_SIZE < STATS_UNKNOWN_COMMAND ? 1 : -1];
+
+Command::Command(const StringView& line, Client* client, Server* server)
+    : _spec(NULL), _client(client), _server(server), _arena(client->getReactor()->getArena()) {
+    if (_message.parse(line))
+        _spec = lookup(_message.getCommand());
+}
+
+Command::~Command() {}
+
+// Getters
+const Command::Spec* Command::getSpec() const { return _spec; }
+const Message& Command::getMessage() const { return _message; }
+Client* Command::getClient() const { return _client; }
+Server* Command::getServer() const { return _server; }
+
+int Command::getSlot() const {
+    if (_message.getCommand().empty())
+        return -1;
+    return _spec ? static_cast<int>(_spec - COMMANDS) : STATS_UNKNOWN_COMMAND;
+}
+
+// Unknown verbs and blank lines only ever answer the sender
+bool Command::isShared() const {
+    return !_spec || _spec->shared;
+}
+
+void Command::sendReply(const std::string& reply) {
+    StringView parts[] = {
+        StringView::from(":" SERVER_NAME " "), StringView::from(reply), StringView::from("\r\n")
+    };
+    _client->sendMessage(_arena.join(parts, 3));
+}
+
+size_t Command::argCount() const {
+    return _message.getParamCount();
+}
+
+std::string Command::arg(size_t index) const {
+    return _message.getParam(index).str();
+}
+
+// ":source COMMAND target :text" for PRIVMSG and NOTICE, built in the arena
+StringView Command::relayLine(const char* command, const StringView& target) {
+    StringView parts[] = {
+        StringView::from(_client->getSource()), StringView::from(" "), StringView::from(command),
+        StringView::from(" "), target, StringView::from(" :"), _message.getParam(1), StringView::from("\r\n")
+    };
+    return _arena.join(parts, 8);
+}
+
+// Appends one applied mode letter, repeating the sign only when it changes.
+static void appendModeChange(std::string& changes, char& sign, bool adding, char mode) {
+    char wanted = adding ? '+' : '-';
+    if (sign != wanted) {
+        changes += wanted;
+        sign = wanted;
+    }
+    changes += mode;
+}
+
+// Command parsing
+static char upper(char c) {
+    return std::toupper(static_cast<unsigned char>(c));
+}
+
+const Command::Spec* Command::lookup(const StringView& verb) {
+    if (verb.empty())
+        return NULL;
+
+    // Length and first letter narrow the verb to one candidate without copying it
+    int id = -1;
+    switch (verb.length) {
+        case 4:
+            switch (upper(verb.data[0])) {
+                case 'J': id = CMD_JOIN; break;
+                case 'K': id = CMD_KICK; break;
+                case 'M': id = CMD_MODE; break;
+                case 'N': id = CMD_NICK; break;
+                case 'O': id = CMD_OPER; break;
+                case 'Q': id = CMD_QUIT; break;
+                case 'U': id = CMD_USER; break;
+                case 'P':
+                    switch (upper(verb.data[1])) {
+                        case 'A': id = upper(verb.data[2]) == 'S' ? CMD_PASS : CMD_PART; break;
+                        case 'I': id = CMD_PING; break;
+                        case 'O': id = CMD_PONG; break;
+                    }
+                    break;
+            }
+            break;
+        case 5:
+            if (upper(verb.data[0]) == 'T')
+                id = CMD_TOPIC;
+            else if (upper(verb.data[0]) == 'N')
+                id = CMD_NAMES;
+            else if (upper(verb.data[0]) == 'S')
+                id = CMD_STATS;
+            break;
+        case 6:
+            if (upper(verb.data[0]) == 'N')
+                id = CMD_NOTICE;
+            else if (upper(verb.data[0]) == 'I')
+                id = CMD_INVITE;
+            break;
+        case 7:
+            if (upper(verb.data[0]) == 'P')
+                id = CMD_PRIVMSG;
+            break;
+    }
+    if (id == -1)
+        return NULL;
+
+    // Confirm the whole verb, case-insensitively
+    const char* name = COMMANDS[id].name;
+    for (size_t i = 0; i < verb.length; ++i) {
+        if (upper(verb.data[i]) != name[i])
+            return NULL;
+    }
+    return &COMMANDS[id];
+}
+
+const Command::Spec* Command::getRegistry(size_t& count) {
+    count = REGISTRY_SIZE;
+    return COMMANDS;
+}
+
+bool Command::isValidNickname(const std::string& nickname) {
+    return Utils::isValidNickname(nickname);
+}
+
+bool Command::isValidChannelName(const std::string& channelName) {
+    return Utils::isValidChannelName(channelName);
+}
+
+// Command execution
+void Command::execute() {
+    // Lines without a command are silently ignored
+    if (_message.getCommand().empty())
+        return;
+
+    if (!_spec) {
+        std::string error = ERR_UNKNOWNCOMMAND(_message.getCommand().str());
+        sendReply(error);
+        return;
+    }
+
+    if (_spec->requiresRegistration && !_client->isRegistered()) {
+        std::string error = ERR_NOTREGISTERED;
+        sendReply(error);
+        return;
+    }
+
+    if (argCount() < _spec->minParams) {
+        std::string error = ERR_NEEDMOREPARAMS(_spec->name);
+        sendReply(error);
+        return;
+    }
+
+    (this->*_spec->handler)();
+}
+
+void Command::executePass() {
+    if (_client->isAuthenticated()) {
+        std::string error = ERR_ALREADYREGISTERED;
+        sendReply(error);
+        return;
+    }
+
+    if (arg(0) == _server->getPassword()) {
+        _client->setAuthenticated(true);
+    } else {
+        std::string error = ERR_PASSWDMISMATCH;
+        sendReply(error);
+    }
+}
+
+void Command::executeNick() {
+    if (argCount() == 0) {
+        std::string error = ERR_NONICKNAMEGIVEN;
+        sendReply(error);
+        return;
+    }
+
+    std::string newNick = arg(0);
+    if (!isValidNickname(newNick)) {
+        std::string error = ERR_ERRONEUSNICKNAME(newNick);
+        sendReply(error);
+        return;
+    }
+
+    // Re-sending the current nickname is not a change
+    if (InternedString(newNick) == _client->getNicknameHandle())
+        return;
+
+    // A client may change the case of its own nickname
+    Client* owner = _server->getClient(newNick);
+    if (owner && owner != _client) {
+        std::string error = ERR_NICKNAMEINUSE(newNick);
+        sendReply(error);
+        return;
+    }
+
+    // Announced under the old source
+    bool renamed = !_client->getNickname().empty();
+    std::string message = _client->getSource() + " NICK " + newNick + "\r\n";
+    _server->setNickname(_client, newNick);
+
+    if (renamed)
+        _server->broadcastToPeers(_client, message);
+}
+
+void Command::executeUser() {
+    if (_client->isRegistered()) {
+        std::string error = ERR_ALREADYREGISTERED;
+        sendReply(error);
+        return;
+    }
+
+    _client->setUsername(arg(0));
+    _client->setRealname(arg(3));
+    _client->setRegistered(true);
+
+    // Send welcome messages
+    std::string welcome = RPL_WELCOME(_client->getNickname());
+    std::string yourHost = RPL_YOURHOST(SERVER_NAME, SERVER_VERSION);
+    std::string created = RPL_CREATED(Utils::getCurrentTimestamp());
+    std::string myInfo = RPL_MYINFO(SERVER_NAME, SERVER_VERSION, "aiwro", "Oov");
+
+    sendReply(welcome);
+    sendReply(yourHost);
+    sendReply(created);
+    sendReply(myInfo);
+}
+
+void Command::executeQuit() {
+    std::string message = _client->getSource() + " QUIT";
+    if (argCount() > 0)
+        message += " :" + arg(0);
+    message += "\r\n";
+
+    _server->broadcastToPeers(_client, message);
+    _server->removeClient(_client);
+}
+
+void Command::executeJoin() {
+    std::vector<std::string> channels = Utils::split(arg(0), ',');
+    std::vector<std::string> keys = argCount() > 1 ? Utils::split(arg(1), ',') : std::vector<std::string>();
+
+    for (size_t i = 0; i < channels.size(); ++i) {
+        std::string channelName = channels[i];
+        if (!isValidChannelName(channelName)) {
+            continue;
+        }
+
+        Channel* channel = _server->getChannel(channelName);
+        if (!channel) {
+            channel = _server->createChannel(channelName);
+        }
+        // Replies use the name the channel was created with
+        channelName = channel->getName();
+
+        if (channel->isInviteOnly() && !channel->isOperator(_client)) {
+            std::string error = ERR_INVITEONLYCHAN(channelName);
+            sendReply(error);
+            continue;
+        }
+
+        if (!channel->getKey().empty() && (i >= keys.size() || keys[i] != channel->getKey())) {
+            std::string error = ERR_BADCHANNELKEY(channelName);
+            sendReply(error);
+            continue;
+        }
+
+        if (channel->getUserLimit() > 0 && channel->size() >= channel->getUserLimit()) {
+            std::string error = ERR_CHANNELISFULL(channelName);
+            sendReply(error);
+            continue;
+        }
+
+        channel->addClient(_client);
+        if (channel->size() == 1) {
+            channel->addOperator(_client);
+        }
+
+        std::string joinMessage = _client->getSource() + " JOIN " + channelName + "\r\n";
+        channel->broadcast(joinMessage);
+
+        // Send channel info
+        std::string topic = channel->getTopic().empty() ? RPL_NOTOPIC(channelName) : RPL_TOPIC(channelName, channel->getTopic());
+        sendReply(topic);
+
+        channel->sendNames(_client);
+    }
+}
+
+void Command::executeNames() {
+    // Without a channel list there is nothing to enumerate but the end marker
+    if (argCount() == 0) {
+        std::string endNames = RPL_ENDOFNAMES("*");
+        sendReply(endNames);
+        return;
+    }
+
+    std::vector<std::string> channels = Utils::split(arg(0), ',');
+    for (size_t i = 0; i < channels.size(); ++i) {
+        Channel* channel = _server->getChannel(channels[i]);
+        if (channel && (!channel->isSecret() || channel->hasClient(_client))) {
+            channel->sendNames(_client);
+        } else {
+            std::string endNames = RPL_ENDOFNAMES(channels[i]);
+            sendReply(endNames);
+        }
+    }
+}
+
+void Command::executePart() {
+    std::vector<std::string> channels = Utils::split(arg(0), ',');
+    std::string reason = argCount() > 1 ? arg(1) : "";
+
+    for (size_t i = 0; i < channels.size(); ++i) {
+        Channel* channel = _server->getChannel(channels[i]);
+        if (!channel) {
+            std::string error = ERR_NOSUCHCHANNEL(channels[i]);
+            sendReply(error);
+            continue;
+        }
+
+        if (!channel->hasClient(_client)) {
+            std::string error = ERR_NOTONCHANNEL(channels[i]);
+            sendReply(error);
+            continue;
+        }
+
+        std::string partMessage = _client->getSource() + " PART " + channels[i];
+        if (!reason.empty())
+            partMessage += " :" + reason;
+        partMessage += "\r\n";
+
+        channel->broadcast(partMessage);
+        _server->partChannel(channel, _client);
+    }
+}
+
+void Command::executePrivmsg() {
+    if (argCount() == 0) {
+        std::string error = ERR_NORECIPIENT("PRIVMSG");
+        sendReply(error);
+        return;
+    }
+
+    if (argCount() < 2 || _message.getParam(1).empty()) {
+        std::string error = ERR_NOTEXTTOSEND;
+        sendReply(error);
+        return;
+    }
+
+    size_t count;
+    StringView* targets = Utils::split(_arena, _message.getParam(0), ',', count);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (targets[i].data[0] == '#' || targets[i].data[0] == '&') {
+            Channel* channel = _server->findChannel(targets[i]);
+            if (!channel) {
+                std::string error = ERR_NOSUCHCHANNEL(targets[i].str());
+                sendReply(error);
+                continue;
+            }
+
+            if (!channel->hasClient(_client)) {
+                std::string error = ERR_CANNOTSENDTOCHAN(targets[i].str());
+                sendReply(error);
+                continue;
+            }
+
+            channel->broadcast(relayLine("PRIVMSG", targets[i]), _client);
+        } else {
+            Client* target = _server->findClient(targets[i]);
+            if (!target) {
+                std::string error = ERR_NOSUCHNICK(targets[i].str());
+                sendReply(error);
+                continue;
+            }
+
+            target->sendMessage(relayLine("PRIVMSG", targets[i]));
+        }
+    }
+}
+
+void Command::executeNotice() {
+    // Similar to PRIVMSG but without error replies
+    if (argCount() < 2)
+        return;
+
+    size_t count;
+    StringView* targets = Utils::split(_arena, _message.getParam(0), ',', count);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (targets[i].data[0] == '#' || targets[i].data[0] == '&') {
+            Channel* channel = _server->findChannel(targets[i]);
+            if (channel && channel->hasClient(_client)) {
+                channel->broadcast(relayLine("NOTICE", targets[i]), _client);
+            }
+        } else {
+            Client* target = _server->findClient(targets[i]);
+            if (target) {
+                target->sendMessage(relayLine("NOTICE", targets[i]));
+            }
+        }
+    }
+}
+
+void Command::executeKick() {
+    Channel* channel = _server->getChannel(arg(0));
+    if (!channel) {
+        std::string error = ERR_NOSUCHCHANNEL(arg(0));
+        sendReply(error);
+        return;
+    }
+
+    if (!channel->isOperator(_client)) {
+        std::string error = ERR_CHANOPRIVSNEEDED(arg(0));
+        sendReply(error);
+        return;
+    }
+
+    Client* target = _server->getClient(arg(1));
+    if (!target || !channel->hasClient(target)) {
+        std::string error = ERR_NOTONCHANNEL(arg(0));
+        sendReply(error);
+        return;
+    }
+
+    std::string reason = argCount() > 2 ? arg(2) : _client->getNickname();
+    std::string kickMessage = _client->getSource() + " KICK " + arg(0) + " " + arg(1) + " :" + reason + "\r\n";
+    channel->broadcast(kickMessage);
+    _server->partChannel(channel, target);
+}
+
+void Command::executeInvite() {
+    Client* target = _server->getClient(arg(0));
+    if (!target) {
+        std::string error = ERR_NOSUCHNICK(arg(0));
+        sendReply(error);
+        return;
+    }
+
+    Channel* channel = _server->getChannel(arg(1));
+    if (!channel) {
+        std::string error = ERR_NOSUCHCHANNEL(arg(1));
+        sendReply(error);
+        return;
+    }
+
+    if (!channel->isOperator(_client)) {
+        std::string error = ERR_CHANOPRIVSNEEDED(arg(1));
+        sendReply(error);
+        return;
+    }
+
+    if (channel->hasClient(target)) {
+        std::string error = "443 " + arg(0) + " " + arg(1) + " :is already on channel";
+        sendReply(error);
+        return;
+    }
+
+    std::string inviteMessage = _client->getSource() + " INVITE " + arg(0) + " " + arg(1) + "\r\n";
+    target->sendMessage(inviteMessage);
+}
+
+void Command::executeTopic() {
+    Channel* channel = _server->getChannel(arg(0));
+    if (!channel) {
+        std::string error = ERR_NOSUCHCHANNEL(arg(0));
+        sendReply(error);
+        return;
+    }
+
+    if (!channel->hasClient(_client)) {
+        std::string error = ERR_NOTONCHANNEL(arg(0));
+        sendReply(error);
+        return;
+    }
+
+    if (argCount() == 1) {
+        std::string reply = channel->getTopic().empty() ? 
+            RPL_NOTOPIC(arg(0)) : RPL_TOPIC(arg(0), channel->getTopic());
+        sendReply(reply);
+        return;
+    }
+
+    if (channel->hasMode('t') && !channel->isOperator(_client)) {
+        std::string error = ERR_CHANOPRIVSNEEDED(arg(0));
+        sendReply(error);
+        return;
+    }
+
+    std::string newTopic = arg(1);
+    channel->setTopic(newTopic);
+
+    std::string topicMessage = _client->getSource() + " TOPIC " + arg(0) + " :" + newTopic + "\r\n";
+    channel->broadcast(topicMessage);
+}
+
+void Command::executeMode() {
+    const StringView& target = _message.getParam(0);
+    if (!target.empty() && (target.data[0] == '#' || target.data[0] == '&')) {
+        Channel* channel = _server->getChannel(arg(0));
+        if (!channel) {
+            std::string error = ERR_NOSUCHCHANNEL(arg(0));
+            sendReply(error);
+            return;
+        }
+
+        if (!channel->isOperator(_client)) {
+            std::string error = ERR_CHANOPRIVSNEEDED(arg(0));
+            sendReply(error);
+            return;
+        }
+
+        if (argCount() == 1) {
+            std::string modeReply = RPL_CHANNELMODEIS(arg(0), channel->getMode());
+            sendReply(modeReply);
+            return;
+        }
+
+        std::string modes = arg(1);
+        bool adding = true;
+        std::string modeChanges;
+        std::string modeArgs;
+        char changeSign = 0;
+        size_t nextArg = 2; // Mode arguments follow the mode string in order
+
+        for (size_t i = 0; i < modes.length(); ++i) {
+            if (modes[i] == '+')
+                adding = true;
+            else if (modes[i] == '-')
+                adding = false;
+            else {
+                switch (modes[i]) {
+                    case 'i':
+                        if (adding)
+                            channel->addMode('i');
+                        else
+                            channel->removeMode('i');
+                        appendModeChange(modeChanges, changeSign, adding, modes[i]);
+                        break;
+                    case 't':
+                        if (adding)
+                            channel->addMode('t');
+                        else
+                            channel->removeMode('t');
+                        appendModeChange(modeChanges, changeSign, adding, modes[i]);
+                        break;
+                    case 'P':
+                        if (adding)
+                            channel->addMode('P');
+                        else
+                            channel->removeMode('P');
+                        appendModeChange(modeChanges, changeSign, adding, modes[i]);
+                        break;
+                    case 'k':
+                        if (adding) {
+                            if (nextArg < argCount()) {
+                                std::string key = arg(nextArg++);
+                                channel->setKey(key);
+                                appendModeChange(modeChanges, changeSign, adding, 'k');
+                                modeArgs += " " + key;
+                            }
+                        } else {
+                            channel->setKey("");
+                            appendModeChange(modeChanges, changeSign, adding, 'k');
+                        }
+                        break;
+                    case 'o':
+                    case 'v':
+                        if (nextArg < argCount()) {
+                            Client* target = _server->getClient(arg(nextArg++));
+                            if (target) {
+                                channel->setStatus(target, modes[i] == 'o' ? MEMBER_OPERATOR : MEMBER_VOICE, adding);
+                                appendModeChange(modeChanges, changeSign, adding, modes[i]);
+                                modeArgs += " " + target->getNickname();
+                            }
+                        }
+                        break;
+                    case 'l':
+                        if (adding) {
+                            if (nextArg < argCount()) {
+                                std::string limit = arg(nextArg++);
+                                channel->setUserLimit(std::atoi(limit.c_str()));
+                                appendModeChange(modeChanges, changeSign, adding, 'l');
+                                modeArgs += " " + limit;
+                            }
+                        } else {
+                            channel->setUserLimit(0);
+                            appendModeChange(modeChanges, changeSign, adding, 'l');
+                        }
+                        break;
+                }
+            }
+        }
+
+        if (!modeChanges.empty()) {
+            std::string modeMessage = _client->getSource() + " MODE " + arg(0) + " " + modeChanges + modeArgs + "\r\n";
+            channel->broadcast(modeMessage);
+        }
+    } else {
+        // User modes (not implemented in this basic version)
+        std::string error = ERR_USERSDONTMATCH;
+        sendReply(error);
+    }
+}
+
+void Command::executePing() {
+    if (argCount() == 0)
+        return;
+
+    StringView parts[] = {
+        StringView::from("PONG " SERVER_NAME " :"), _message.getParam(0), StringView::from("\r\n")
+    };
+    _client->sendMessage(_arena.join(parts, 3));
+}
+
+void Command::executePong() {
+    // PONG is just acknowledged, no response needed
+}
+
+void Command::executeOper() {
+    if (!_server->hasOperator()) {
+        std::string error = ERR_NOOPERHOST;
+        sendReply(error);
+        return;
+    }
+
+    if (!_server->checkOperator(arg(0), arg(1))) {
+        std::string error = ERR_PASSWDMISMATCH;
+        sendReply(error);
+        return;
+    }
+
+    _client->addMode('o');
+    std::string reply = RPL_YOUREOPER;
+    sendReply(reply);
+    _client->sendMessage(_client->getSource() + " MODE " + _client->getNickname() + " :+o\r\n");
+}
+
+// STATS reports
+static std::string formatDuration(uint64_t nanoseconds) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (nanoseconds < 1000)
+        out << nanoseconds << "ns";
+    else if (nanoseconds < 1000000)
+        out << nanoseconds / 1e3 << "us";
+    else if (nanoseconds < 1000000000)
+        out << nanoseconds / 1e6 << "ms";
+    else
+        out << nanoseconds / 1e9 << "s";
+    return out.str();
+}
+
+// "command slow 12.5ms PRIVMSG #chan members=200 bytes=9800 at=1718000000.123"
+static std::string formatTrace(const TraceRecord& record) {
+    std::ostringstream out;
+    out << (record.kind == TraceRecord::COMMAND ? "command " : "loop ")
+        << (record.reason == TraceRecord::SLOW ? "slow " : "sampled ")
+        << formatDuration(record.duration);
+    if (record.kind == TraceRecord::COMMAND) {
+        out << " " << record.verb;
+        if (record.target[0])
+            out << " " << record.target;
+        out << " members=" << record.members;
+    } else {
+        out << " events=" << record.events;
+    }
+    out << " bytes=" << record.bytes
+        << " at=" << record.time / 1000000000ULL << "." << std::setfill('0') << std::setw(3)
+        << (record.time / 1000000ULL) % 1000;
+    return out.str();
+}
+
+static std::string formatHistogram(const std::string& label, const Histogram& histogram) {
+    std::ostringstream out;
+    out << label << " count=" << histogram.getCount()
+        << " mean=" << formatDuration(histogram.getSum() / histogram.getCount())
+        << " p50=" << formatDuration(histogram.percentile(0.50))
+        << " p90=" << formatDuration(histogram.percentile(0.90))
+        << " p99=" << formatDuration(histogram.percentile(0.99))
+        << " max=" << formatDuration(histogram.getMax());
+    return out.str();
+}
+
+static std::string formatPool(ObjectPool& pool) {
+    ObjectPool::Stats stats = pool.getStats();
+    std::ostringstream out;
+    out << pool.getName() << "_pool in_use=" << stats.inUse << " capacity=" << stats.capacity
+        << " peak=" << stats.peak << " slabs=" << stats.slabs << " huge_slabs=" << stats.hugeSlabs;
+    return out.str();
+}
+
+void Command::executeStats() {
+    if (!_client->hasMode('o')) {
+        std::string error = ERR_NOPRIVILEGES;
+        sendReply(error);
+        return;
+    }
+
+    // m: calls per verb, l: latency per verb, t: traffic and loop time,
+    // u: uptime, w: watchdog trace log, z: memory pools
+    std::string query = arg(0);
+    char letter = query.empty() ? '*' : query[0];
+
+    if (letter == 'm' || letter == 'l' || letter == 't') {
+        Stats total;
+        _server->collectStats(total);
+
+        size_t count;
+        const Spec* registry = getRegistry(count);
+        for (size_t i = 0; i <= count; ++i) {
+            size_t slot = i < count ? i : STATS_UNKNOWN_COMMAND;
+            const Histogram& histogram = total.getCommand(slot);
+            if (histogram.getCount() == 0 || letter == 't')
+                continue;
+
+            std::string name = i < count ? registry[i].name : "UNKNOWN";
+            std::ostringstream calls;
+            calls << histogram.getCount();
+            if (letter == 'm')
+                sendReply(RPL_STATSCOMMANDS(name, calls.str()));
+            else
+                sendReply(RPL_STATSDEBUG(formatHistogram(name, histogram)));
+        }
+
+        if (letter == 't') {
+            std::ostringstream traffic;
+            traffic << "traffic bytes_in=" << total.get(Stats::BYTES_IN)
+                    << " bytes_out=" << total.get(Stats::BYTES_OUT)
+                    << " accepts=" << total.get(Stats::ACCEPTS)
+                    << " rejects=" << total.get(Stats::REJECTS)
+                    << " disconnects=" << total.get(Stats::DISCONNECTS)
+                    << " bytes_queued=" << total.get(Stats::BYTES_QUEUED);
+            sendReply(RPL_STATSDEBUG(traffic.str()));
+            if (total.getIterations().getCount() > 0)
+                sendReply(RPL_STATSDEBUG(formatHistogram("loop", total.getIterations())));
+        }
+    } else if (letter == 'u') {
+        long uptime = time(NULL) - _server->getStartTime();
+        std::ostringstream out;
+        out << uptime / 86400 << " days " << (uptime / 3600) % 24 << ":"
+            << std::setfill('0') << std::setw(2) << (uptime / 60) % 60 << ":"
+            << std::setw(2) << uptime % 60;
+        sendReply(RPL_STATSUPTIME(out.str()));
+    } else if (letter == 'w') {
+        std::vector<TraceRecord> records;
+        uint64_t written = _server->getTraceLog().snapshot(records);
+        std::ostringstream header;
+        header << "trace written=" << written << " kept=" << records.size()
+               << " budget=" << (_server->getTraceBudget() ? formatDuration(_server->getTraceBudget()) : "off")
+               << " sampling=";
+        if (_server->getTraceSampling())
+            header << "1/" << _server->getTraceSampling();
+        else
+            header << "off";
+        sendReply(RPL_STATSDEBUG(header.str()));
+        for (size_t i = 0; i < records.size(); ++i)
+            sendReply(RPL_STATSDEBUG(formatTrace(records[i])));
+    } else if (letter == 'z') {
+        sendReply(RPL_STATSDEBUG(formatPool(Client::getPool())));
+        sendReply(RPL_STATSDEBUG(formatPool(Channel::getPool())));
+        std::ostringstream interned;
+        interned << "interned_strings count=" << InternedString::count();
+        sendReply(RPL_STATSDEBUG(interned.str()));
+    }
+
+    std::string end = RPL_ENDOFSTATS(std::string(1, letter));
+    sendReply(end);
+}
@@ -0,0 +1,81 @@
+#include "../include/ConnectionTable.hpp"
+#include "../include/Client.hpp"
+
+ConnectionTable::ConnectionTable() {}
+
+ConnectionTable::~ConnectionTable() {}
+
+// Getters
+size_t ConnectionTable::size() const { return _dense.size(); }
+bool ConnectionTable::empty() const { return _dense.empty(); }
+const std::vector<Client*>& ConnectionTable::getClients() const { return _dense; }
+
+// Table operations
+ConnectionTable::Handle ConnectionTable::insert(int fd, Client* client) {
+    if (fd >= (int)_slots.size()) {
+        Slot empty;
+        empty.client = NULL;
+        empty.generation = 0;
+        empty.index = 0;
+        _slots.resize(fd + 1, empty);
+    }
+
+    Slot& slot = _slots[fd];
+    if (slot.client)
+        remove(fd);
+
+    slot.client = client;
+    slot.generation++;
+    slot.index = _dense.size();
+    _dense.push_back(client);
+
+    Handle handle;
+    handle.fd = fd;
+    handle.generation = slot.generation;
+    return handle;
+}
+
+Client* ConnectionTable::remove(int fd) {
+    if (fd < 0 || fd >= (int)_slots.size() || !_slots[fd].client)
+        return NULL;
+
+    Slot& slot = _slots[fd];
+    Client* client = slot.client;
+
+    // Swap the last live client into the vacated position
+    size_t last = _dense.size() - 1;
+    if (slot.index != last) {
+        Client* moved = _dense[last];
+        _dense[slot.index] = moved;
+        _slots[moved->getFd()].index = slot.index;
+    }
+    _dense.pop_back();
+
+    slot.client = NULL;
+    slot.generation++; // Invalidate outstanding handles
+    return client;
+}
+
+Client* ConnectionTable::find(int fd) const {
+    if (fd < 0 || fd >= (int)_slots.size())
+        return NULL;
+    return _slots[fd].client;
+}
+
+Client* ConnectionTable::find(const Handle& handle) const {
+    return isValid(handle) ? _slots[handle.fd].client : NULL;
+}
+
+ConnectionTable::Handle ConnectionTable::getHandle(int fd) const {
+    Handle handle;
+    handle.fd = fd;
+    handle.generation = (fd >= 0 && fd < (int)_slots.size()) ? _slots[fd].generation : 0;
+    return handle;
+}
+
+bool ConnectionTable::isValid(const Handle& handle) const {
+    if (handle.fd < 0 || handle.fd >= (int)_slots.size())
+        return false;
+    const Slot& slot = _slots[handle.fd];
+    return slot.client != NULL && slot.generation == handle.generation;
+}
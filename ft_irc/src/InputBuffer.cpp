@@ -0,0 +1,102 @@
+#include "../include/InputBuffer.hpp"
+
+InputBuffer::InputBuffer() : _start(0), _end(0), _scan(0), _discarding(false) {}
+
+InputBuffer::~InputBuffer() {}
+
+// Getters
+size_t InputBuffer::size() const { return _end - _start; }
+
+// Filling
+void InputBuffer::compact() {
+    std::memmove(_data, _data + _start, _end - _start);
+    _end -= _start;
+    _scan -= _start;
+    _start = 0;
+}
+
+char* InputBuffer::reserve(size_t& available) {
+    // Everything consumed: rewind for free; otherwise move only when the tail is short
+    if (_start == _end)
+        _start = _end = _scan = 0;
+    else if (INPUT_BUFFER_SIZE - _end < MAX_LINE_LENGTH)
+        compact();
+
+    available = INPUT_BUFFER_SIZE - _end;
+    return _data + _end;
+}
+
+void InputBuffer::commit(size_t length) {
+    _end += length;
+}
+
+size_t InputBuffer::append(const char* data, size_t length) {
+    size_t available;
+    char* tail = reserve(available);
+    if (length > available)
+        length = available;
+    std::memcpy(tail, data, length);
+    commit(length);
+    return length;
+}
+
+void InputBuffer::clear() {
+    _start = _end = _scan = 0;
+    _discarding = false;
+}
+
+// Framing
+// Drops CR and NUL bytes left inside a line, moving the rest down in place
+static size_t stripControls(char* data, size_t length) {
+    if (!std::memchr(data, '\r', length) && !std::memchr(data, '\0', length))
+        return length;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] != '\r' && data[i] != '\0')
+            data[kept++] = data[i];
+    }
+    return kept;
+}
+
+InputBuffer::Status InputBuffer::next(StringView& line) {
+    for (;;) {
+        const char* newline = static_cast<const char*>(std::memchr(_data + _scan, '\n', _end - _scan));
+
+        if (!newline) {
+            _scan = _end;
+            if (_end - _start < MAX_LINE_LENGTH)
+                return LINE_NONE;
+
+            // No terminator within the limit: drop what we have and skip to the next LF
+            bool reported = _discarding;
+            _discarding = true;
+            _start = _end;
+            return reported ? LINE_NONE : LINE_TOO_LONG;
+        }
+
+        size_t pos = newline - _data;
+        _scan = pos + 1;
+
+        size_t lineStart = _start;
+        _start = _scan;
+
+        // Tail end of a line that was already reported
+        if (_discarding) {
+            _discarding = false;
+            continue;
+        }
+
+        // Every LF ends a line, with or without a CR before it, so a client
+        // cannot hide a second line inside one it sends
+        size_t length = pos - lineStart;
+        if (length > 0 && _data[pos - 1] == '\r')
+            --length;
+        if (length + 2 > MAX_LINE_LENGTH)
+            return LINE_TOO_LONG;
+
+        line.data = _data + lineStart;
+        line.length = stripControls(_data + lineStart, length);
+        return LINE_READY;
+    }
+}
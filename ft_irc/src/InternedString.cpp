@@ -0,0 +1,86 @@
+#include "../include/InternedString.hpp"
+#include "../include/Mutex.hpp"
+
+struct Registry {
+    Mutex lock;
+    std::tr1::unordered_map<std::string, unsigned int> entries;
+};
+
+// Never destroyed: reactor threads may still drop handles during exit
+static Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+static const std::string EMPTY_STRING;
+
+InternedString::Entry* InternedString::acquire(const std::string& value) {
+    if (value.empty())
+        return NULL;
+
+    // Elements of an unordered_map keep their address across rehashing
+    Registry& reg = registry();
+    ScopedLock lock(reg.lock);
+    Entry& entry = *reg.entries.insert(std::make_pair(value, 0u)).first;
+    ++entry.second;
+    return &entry;
+}
+
+void InternedString::retain(Entry* entry) {
+    if (!entry)
+        return;
+    ScopedLock lock(registry().lock);
+    ++entry->second;
+}
+
+void InternedString::release(Entry* entry) {
+    if (!entry)
+        return;
+    Registry& reg = registry();
+    ScopedLock lock(reg.lock);
+    if (--entry->second == 0)
+        reg.entries.erase(entry->first);
+}
+
+InternedString::InternedString() : _entry(NULL) {}
+
+InternedString::InternedString(const std::string& value) : _entry(acquire(value)) {}
+
+InternedString::InternedString(const InternedString& other) : _entry(other._entry) {
+    retain(_entry);
+}
+
+InternedString& InternedString::operator=(const InternedString& other) {
+    if (_entry != other._entry) {
+        retain(other._entry);
+        release(_entry);
+        _entry = other._entry;
+    }
+    return *this;
+}
+
+InternedString::~InternedString() {
+    release(_entry);
+}
+
+const std::string& InternedString::str() const {
+    return _entry ? _entry->first : EMPTY_STRING;
+}
+
+bool InternedString::empty() const {
+    return _entry == NULL;
+}
+
+bool InternedString::operator==(const InternedString& other) const {
+    return _entry == other._entry;
+}
+
+bool InternedString::operator!=(const InternedString& other) const {
+    return _entry != other._entry;
+}
+
+size_t InternedString::count() {
+    Registry& reg = registry();
+    ScopedLock lock(reg.lock);
+    return reg.entries.size();
+}
@@ -0,0 +1,181 @@
+#include "../include/IoUring.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned nrArgs) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+IoUring::IoUring(unsigned entries)
+    : _ringFd(-1), _sqRing(MAP_FAILED), _sqRingSize(0), _sqes(NULL), _sqesSize(0),
+      _sqLocalTail(0), _toSubmit(0), _cqRing(MAP_FAILED), _cqRingSize(0),
+      _bufRing(NULL), _bufRingSize(0), _bufMemory(NULL), _bufCount(0), _bufSize(0),
+      _bufTail(0), _bufGroup(0) {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    _ringFd = ioUringSetup(entries, &params);
+    if (_ringFd == -1)
+        throw std::runtime_error("io_uring_setup failed");
+
+    // Map the rings; with IORING_FEAT_SINGLE_MMAP both live in one mapping
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && _cqRingSize > _sqRingSize)
+        _sqRingSize = _cqRingSize;
+
+    _sqRing = mmap(NULL, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   _ringFd, IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED) {
+        close(_ringFd);
+        throw std::runtime_error("Failed to map io_uring submission ring");
+    }
+    if (single) {
+        _cqRing = _sqRing;
+    } else {
+        _cqRing = mmap(NULL, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       _ringFd, IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED) {
+            munmap(_sqRing, _sqRingSize);
+            close(_ringFd);
+            throw std::runtime_error("Failed to map io_uring completion ring");
+        }
+    }
+
+    _sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      _ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (_cqRing != _sqRing)
+            munmap(_cqRing, _cqRingSize);
+        munmap(_sqRing, _sqRingSize);
+        close(_ringFd);
+        throw std::runtime_error("Failed to map io_uring submission entries");
+    }
+    _sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(_sqRing);
+    _sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    _sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    _sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    _sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    _sqEntries = params.sq_entries;
+    _sqLocalTail = *_sqTail;
+
+    char* cq = static_cast<char*>(_cqRing);
+    _cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    _cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+IoUring::~IoUring() {
+    // Closing the ring cancels outstanding requests before buffers go away
+    close(_ringFd);
+    munmap(_sqes, _sqesSize);
+    if (_cqRing != _sqRing)
+        munmap(_cqRing, _cqRingSize);
+    munmap(_sqRing, _sqRingSize);
+    if (_bufRing)
+        munmap(_bufRing, _bufRingSize);
+    delete[] _bufMemory;
+}
+
+// Submission
+struct io_uring_sqe* IoUring::getSqe() {
+    // Ring full: push what we have to the kernel first. It may take none,
+    // e.g. while the completion ring is overflowing; then the caller retries
+    // on a later iteration
+    if (_sqLocalTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _sqEntries) {
+        if (submitAndWait(0) == -1)
+            return NULL;
+        if (_sqLocalTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _sqEntries)
+            return NULL;
+    }
+
+    unsigned index = _sqLocalTail & *_sqMask;
+    struct io_uring_sqe* sqe = &_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    _sqArray[index] = index;
+    _sqLocalTail++;
+    _toSubmit++;
+    return sqe;
+}
+
+int IoUring::submitAndWait(unsigned waitFor) {
+    __atomic_store_n(_sqTail, _sqLocalTail, __ATOMIC_RELEASE);
+
+    unsigned flags = waitFor ? IORING_ENTER_GETEVENTS : 0;
+    int result = ioUringEnter(_ringFd, _toSubmit, waitFor, flags);
+    if (result >= 0)
+        _toSubmit -= (unsigned)result < _toSubmit ? result : _toSubmit;
+    return result;
+}
+
+// Completion
+struct io_uring_cqe* IoUring::peekCompletion() {
+    unsigned head = *_cqHead;
+    if (head == __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE))
+        return NULL;
+    return &_cqes[head & *_cqMask];
+}
+
+void IoUring::advanceCompletion() {
+    __atomic_store_n(_cqHead, *_cqHead + 1, __ATOMIC_RELEASE);
+}
+
+// Provided buffers
+void IoUring::setupBuffers(unsigned short group, unsigned count, size_t size) {
+    _bufRingSize = count * sizeof(struct io_uring_buf);
+    void* ring = mmap(NULL, _bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED)
+        throw std::runtime_error("Failed to allocate io_uring buffer ring");
+    _bufRing = static_cast<struct io_uring_buf_ring*>(ring);
+
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(_bufRing);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (ioUringRegister(_ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1)
+        throw std::runtime_error("Failed to register io_uring buffer ring");
+
+    _bufMemory = new char[count * size];
+    _bufCount = count;
+    _bufSize = size;
+    _bufGroup = group;
+    _bufTail = 0;
+    for (unsigned i = 0; i < count; ++i)
+        recycleBuffer(i);
+}
+
+unsigned short IoUring::getBufferGroup() const {
+    return _bufGroup;
+}
+
+char* IoUring::getBuffer(unsigned short id) const {
+    return _bufMemory + (size_t)id * _bufSize;
+}
+
+void IoUring::recycleBuffer(unsigned short id) {
+    // Index from the ring base: in C++ the header's flex-array wrapper shifts bufs[] by 8 bytes
+    struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(_bufRing) + (_bufTail & (_bufCount - 1));
+    buf->addr = reinterpret_cast<uint64_t>(getBuffer(id));
+    buf->len = _bufSize;
+    buf->bid = id;
+    _bufTail++;
+    __atomic_store_n(&_bufRing->tail, _bufTail, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,86 @@
+#include "../include/Message.hpp"
+#include <cstring>
+
+static const StringView EMPTY_VIEW = { "", 0 };
+
+Message::Message() : _tags(EMPTY_VIEW), _prefix(EMPTY_VIEW), _command(EMPTY_VIEW), _paramCount(0) {}
+
+// Parsing
+static StringView takeWord(const char*& pos, const char* end) {
+    StringView word;
+    word.data = pos;
+    while (pos < end && *pos != ' ')
+        ++pos;
+    word.length = pos - word.data;
+    return word;
+}
+
+static void skipSpaces(const char*& pos, const char* end) {
+    while (pos < end && *pos == ' ')
+        ++pos;
+}
+
+// A CR, LF or NUL in a parameter would end the line early when it is
+// relayed, letting the sender forge the lines after it
+static bool hasTerminator(const StringView& line) {
+    return std::memchr(line.data, '\n', line.length) || std::memchr(line.data, '\r', line.length)
+        || std::memchr(line.data, '\0', line.length);
+}
+
+bool Message::parse(const StringView& line) {
+    const char* pos = line.data;
+    const char* end = line.data + line.length;
+
+    _tags = EMPTY_VIEW;
+    _prefix = EMPTY_VIEW;
+    _command = EMPTY_VIEW;
+    _paramCount = 0;
+
+    // Framing already strips these; the parser does not rely on it
+    if (hasTerminator(line))
+        return false;
+
+    skipSpaces(pos, end);
+    if (pos < end && *pos == '@') {
+        ++pos;
+        _tags = takeWord(pos, end);
+        skipSpaces(pos, end);
+    }
+    if (pos < end && *pos == ':') {
+        ++pos;
+        _prefix = takeWord(pos, end);
+        skipSpaces(pos, end);
+    }
+
+    _command = takeWord(pos, end);
+    if (_command.empty())
+        return false;
+
+    for (;;) {
+        skipSpaces(pos, end);
+        if (pos == end)
+            break;
+
+        // The trailing parameter, or the 15th, runs to the end of the line
+        if (*pos == ':' || _paramCount == MAX_PARAMS - 1) {
+            if (*pos == ':')
+                ++pos;
+            _params[_paramCount].data = pos;
+            _params[_paramCount].length = end - pos;
+            ++_paramCount;
+            break;
+        }
+        _params[_paramCount++] = takeWord(pos, end);
+    }
+    return true;
+}
+
+// Getters
+const StringView& Message::getTags() const { return _tags; }
+const StringView& Message::getPrefix() const { return _prefix; }
+const StringView& Message::getCommand() const { return _command; }
+size_t Message::getParamCount() const { return _paramCount; }
+
+const StringView& Message::getParam(size_t index) const {
+    return index < _paramCount ? _params[index] : EMPTY_VIEW;
+}
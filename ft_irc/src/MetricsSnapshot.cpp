@@ -0,0 +1,240 @@
+#include "../include/MetricsSnapshot.hpp"
+#include "../include/Server.hpp"
+#include "../include/Client.hpp"
+#include "../include/Channel.hpp"
+#include "../include/Command.hpp"
+#include "../include/Stats.hpp"
+#include "../include/ObjectPool.hpp"
+#include "../include/InternedString.hpp"
+#include <sstream>
+#include <ctime>
+
+// Upper bounds of the distribution buckets; the last bucket is +Inf
+static const uint64_t MEMBER_BOUNDS[SNAPSHOT_MEMBER_BUCKETS - 1] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 5000, 10000
+};
+static const uint64_t CHANNEL_BOUNDS[SNAPSHOT_CHANNEL_BUCKETS - 1] = {
+    0, 1, 2, 5, 10, 20, 50
+};
+
+// Latency buckets are powers of four from 256 ns to 4.3 s; they fall on
+// Histogram bucket edges, so their counts are exact
+#define LATENCY_FIRST_SHIFT 8
+#define LATENCY_LAST_SHIFT 32
+
+static size_t binOf(uint64_t value, const uint64_t* bounds, size_t count) {
+    size_t bin = 0;
+    while (bin < count && value > bounds[bin])
+        ++bin;
+    return bin;
+}
+
+MetricsSnapshot::MetricsSnapshot(Server* server)
+    : _server(server), _phase(WALK_CLIENTS), _reactor(0), _index(0), _bucket(0), _bucketCount(0),
+      _clients(0), _registered(0), _queuedBytes(0), _maxQueuedBytes(0), _channels(0), _memberships(0),
+      _started(Stats::now()), _longestSlice(0), _slices(0) {
+    for (size_t i = 0; i < SNAPSHOT_CHANNEL_BUCKETS; ++i)
+        _clientChannels[i] = 0;
+    for (size_t i = 0; i < SNAPSHOT_MEMBER_BUCKETS; ++i)
+        _channelMembers[i] = 0;
+}
+
+// Walk
+bool MetricsSnapshot::advance() {
+    if (_phase == DONE)
+        return true;
+
+    uint64_t started = Stats::now();
+    uint64_t deadline = started + SNAPSHOT_SLICE_NS;
+    {
+        ScopedLock lock(_server->getStateLock(), true);
+        if (_phase == WALK_CLIENTS && walkClients(deadline))
+            _phase = WALK_CHANNELS;
+        if (_phase == WALK_CHANNELS && walkChannels(deadline)) {
+            _phase = DONE;
+            _clients = _server->getClientCount();
+            _channels = _server->getChannels().size();
+        }
+    }
+
+    uint64_t elapsed = Stats::now() - started;
+    if (elapsed > _longestSlice)
+        _longestSlice = elapsed;
+    ++_slices;
+    return _phase == DONE;
+}
+
+bool MetricsSnapshot::isComplete() const {
+    return _phase == DONE;
+}
+
+bool MetricsSnapshot::walkClients(uint64_t deadline) {
+    const std::vector<Reactor*>& reactors = _server->getReactors();
+    size_t visited = 0;
+
+    for (; _reactor < reactors.size(); ++_reactor, _index = 0) {
+        const std::vector<Client*>& clients = reactors[_reactor]->getClients().getClients();
+        for (; _index < clients.size(); ++_index) {
+            if (++visited % SNAPSHOT_CHECK_INTERVAL == 0 && Stats::now() >= deadline)
+                return false;
+
+            // Queue sizes belong to the owning reactor; see OutputQueue::size
+            const Client* client = clients[_index];
+            size_t queued = client->getPendingOutput();
+            _queuedBytes += queued;
+            if (queued > _maxQueuedBytes)
+                _maxQueuedBytes = queued;
+            if (client->isRegistered())
+                ++_registered;
+            ++_clientChannels[binOf(client->getChannels().size(), CHANNEL_BOUNDS, SNAPSHOT_CHANNEL_BUCKETS - 1)];
+        }
+    }
+    return true;
+}
+
+bool MetricsSnapshot::walkChannels(uint64_t deadline) {
+    // Bucket positions only stay meaningful while the table keeps its size
+    const ChannelMap& channels = _server->getChannels();
+    if (channels.bucket_count() != _bucketCount)
+        resetChannels();
+
+    size_t visited = 0;
+    for (; _bucket < _bucketCount; ++_bucket) {
+        if (++visited % SNAPSHOT_CHECK_INTERVAL == 0 && Stats::now() >= deadline)
+            return false;
+
+        ChannelMap::const_local_iterator end = channels.end(_bucket);
+        for (ChannelMap::const_local_iterator it = channels.begin(_bucket); it != end; ++it) {
+            size_t members = it->second->size();
+            _memberships += members;
+            ++_channelMembers[binOf(members, MEMBER_BOUNDS, SNAPSHOT_MEMBER_BUCKETS - 1)];
+        }
+    }
+    return true;
+}
+
+void MetricsSnapshot::resetChannels() {
+    _bucket = 0;
+    _bucketCount = _server->getChannels().bucket_count();
+    _memberships = 0;
+    for (size_t i = 0; i < SNAPSHOT_MEMBER_BUCKETS; ++i)
+        _channelMembers[i] = 0;
+}
+
+// Rendering
+static void writeHeader(std::ostream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP ircserv_" << name << " " << help << "\n"
+        << "# TYPE ircserv_" << name << " " << type << "\n";
+}
+
+// Counters are written as integers so large values stay exact
+static void writeMetric(std::ostream& out, const char* name, const char* type, const char* help, uint64_t value) {
+    writeHeader(out, name, type, help);
+    out << "ircserv_" << name << " " << value << "\n";
+}
+
+static void writeMetric(std::ostream& out, const char* name, const char* type, const char* help, double value) {
+    writeHeader(out, name, type, help);
+    out << "ircserv_" << name << " " << value << "\n";
+}
+
+static std::string withLabel(const std::string& labels, const std::string& label) {
+    return "{" + labels + (labels.empty() ? "" : ",") + label + "}";
+}
+
+static void writeDistribution(std::ostream& out, const char* name, const uint64_t* bounds,
+                              const uint64_t* bins, size_t count, uint64_t sum) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += bins[i];
+        out << "ircserv_" << name << "_bucket{le=\"";
+        if (i + 1 < count)
+            out << bounds[i];
+        else
+            out << "+Inf";
+        out << "\"} " << total << "\n";
+    }
+    out << "ircserv_" << name << "_sum " << sum << "\n"
+        << "ircserv_" << name << "_count " << total << "\n";
+}
+
+static void writeLatency(std::ostream& out, const char* name, const std::string& labels, const Histogram& histogram) {
+    for (int shift = LATENCY_FIRST_SHIFT; shift <= LATENCY_LAST_SHIFT; shift += 2) {
+        uint64_t limit = 1ULL << shift;
+        std::ostringstream le;
+        le << "le=\"" << limit / 1e9 << "\"";
+        out << "ircserv_" << name << "_bucket" << withLabel(labels, le.str()) << " "
+            << histogram.countBelow(limit) << "\n";
+    }
+    std::string suffix = labels.empty() ? "" : "{" + labels + "}";
+    out << "ircserv_" << name << "_bucket" << withLabel(labels, "le=\"+Inf\"") << " " << histogram.getCount() << "\n"
+        << "ircserv_" << name << "_sum" << suffix << " " << histogram.getSum() / 1e9 << "\n"
+        << "ircserv_" << name << "_count" << suffix << " " << histogram.getCount() << "\n";
+}
+
+std::string MetricsSnapshot::render() const {
+    Stats stats;
+    _server->collectStats(stats);
+
+    std::ostringstream out;
+    out.precision(9);
+
+    writeMetric(out, "uptime_seconds", "gauge", "Seconds since the server started.",
+                static_cast<uint64_t>(time(NULL) - _server->getStartTime()));
+    writeMetric(out, "clients", "gauge", "Connected clients.", _clients);
+    writeMetric(out, "clients_registered", "gauge", "Clients that completed registration.", _registered);
+    writeMetric(out, "channels", "gauge", "Existing channels.", _channels);
+    writeMetric(out, "output_queue_bytes", "gauge", "Bytes queued for delivery across all clients.", _queuedBytes);
+    writeMetric(out, "output_queue_max_bytes", "gauge", "Largest single client output queue.", _maxQueuedBytes);
+
+    writeHeader(out, "channel_members", "histogram", "Channels by member count.");
+    writeDistribution(out, "channel_members", MEMBER_BOUNDS, _channelMembers, SNAPSHOT_MEMBER_BUCKETS, _memberships);
+    writeHeader(out, "client_channels", "histogram", "Clients by number of channels joined.");
+    writeDistribution(out, "client_channels", CHANNEL_BOUNDS, _clientChannels, SNAPSHOT_CHANNEL_BUCKETS, _memberships);
+
+    writeMetric(out, "received_bytes_total", "counter", "Bytes read from clients.", stats.get(Stats::BYTES_IN));
+    writeMetric(out, "sent_bytes_total", "counter", "Bytes written to clients.", stats.get(Stats::BYTES_OUT));
+    writeMetric(out, "connections_accepted_total", "counter", "Connections admitted.", stats.get(Stats::ACCEPTS));
+    writeMetric(out, "connections_rejected_total", "counter", "Connections refused by admission control.",
+                stats.get(Stats::REJECTS));
+    writeMetric(out, "disconnects_total", "counter", "Connections closed.", stats.get(Stats::DISCONNECTS));
+    writeMetric(out, "queued_bytes_total", "counter", "Bytes of output produced for clients.",
+                stats.get(Stats::BYTES_QUEUED));
+    writeMetric(out, "trace_records_total", "counter", "Slow or sampled events written to the trace log.",
+                _server->getTraceLog().getWritten());
+
+    size_t count;
+    const Command::Spec* registry = Command::getRegistry(count);
+    writeHeader(out, "commands_total", "counter", "Commands executed, by verb.");
+    for (size_t i = 0; i <= count; ++i) {
+        const char* name = i < count ? registry[i].name : "UNKNOWN";
+        const Histogram& histogram = stats.getCommand(i < count ? i : STATS_UNKNOWN_COMMAND);
+        out << "ircserv_commands_total{command=\"" << name << "\"} " << histogram.getCount() << "\n";
+    }
+    writeHeader(out, "command_duration_seconds", "histogram", "Command handler time, by verb.");
+    for (size_t i = 0; i <= count; ++i) {
+        const char* name = i < count ? registry[i].name : "UNKNOWN";
+        const Histogram& histogram = stats.getCommand(i < count ? i : STATS_UNKNOWN_COMMAND);
+        writeLatency(out, "command_duration_seconds", std::string("command=\"") + name + "\"", histogram);
+    }
+    writeHeader(out, "loop_busy_seconds", "histogram", "Event-loop iteration time, excluding the wait.");
+    writeLatency(out, "loop_busy_seconds", "", stats.getIterations());
+
+    ObjectPool::Stats clientPool = Client::getPool().getStats();
+    ObjectPool::Stats channelPool = Channel::getPool().getStats();
+    writeHeader(out, "pool_slots_in_use", "gauge", "Object pool slots in use.");
+    out << "ircserv_pool_slots_in_use{pool=\"client\"} " << clientPool.inUse << "\n"
+        << "ircserv_pool_slots_in_use{pool=\"channel\"} " << channelPool.inUse << "\n";
+    writeHeader(out, "pool_slots", "gauge", "Object pool slots carved.");
+    out << "ircserv_pool_slots{pool=\"client\"} " << clientPool.capacity << "\n"
+        << "ircserv_pool_slots{pool=\"channel\"} " << channelPool.capacity << "\n";
+    writeMetric(out, "interned_strings", "gauge", "Distinct identity strings interned.",
+                static_cast<uint64_t>(InternedString::count()));
+
+    writeMetric(out, "scrape_slices", "gauge", "Slices the state walk of this scrape took.", _slices);
+    writeMetric(out, "scrape_longest_slice_seconds", "gauge", "Longest the state lock was held by this scrape.",
+                _longestSlice / 1e9);
+    writeMetric(out, "scrape_walk_seconds", "gauge", "Wall time of this scrape's state walk.",
+                (Stats::now() - _started) / 1e9);
+    return out.str();
+}
@@ -0,0 +1,63 @@
+#include "../include/Mutex.hpp"
+#include <stdexcept>
+
+Mutex::Mutex() {
+    if (pthread_mutex_init(&_mutex, NULL) != 0)
+        throw std::runtime_error("Failed to initialize mutex");
+}
+
+Mutex::~Mutex() {
+    pthread_mutex_destroy(&_mutex);
+}
+
+void Mutex::lock() {
+    pthread_mutex_lock(&_mutex);
+}
+
+void Mutex::unlock() {
+    pthread_mutex_unlock(&_mutex);
+}
+
+SharedMutex::SharedMutex() {
+    pthread_rwlockattr_t attributes;
+    pthread_rwlockattr_init(&attributes);
+    pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    int result = pthread_rwlock_init(&_lock, &attributes);
+    pthread_rwlockattr_destroy(&attributes);
+    if (result != 0)
+        throw std::runtime_error("Failed to initialize readers-writer lock");
+}
+
+SharedMutex::~SharedMutex() {
+    pthread_rwlock_destroy(&_lock);
+}
+
+void SharedMutex::lock() {
+    pthread_rwlock_wrlock(&_lock);
+}
+
+void SharedMutex::lockShared() {
+    pthread_rwlock_rdlock(&_lock);
+}
+
+void SharedMutex::unlock() {
+    pthread_rwlock_unlock(&_lock);
+}
+
+ScopedLock::ScopedLock(Mutex& mutex) : _mutex(&mutex), _shared(NULL) {
+    _mutex->lock();
+}
+
+ScopedLock::ScopedLock(SharedMutex& mutex, bool shared) : _mutex(NULL), _shared(&mutex) {
+    if (shared)
+        _shared->lockShared();
+    else
+        _shared->lock();
+}
+
+ScopedLock::~ScopedLock() {
+    if (_mutex)
+        _mutex->unlock();
+    else
+        _shared->unlock();
+}
@@ -0,0 +1,154 @@
+#include "../include/ObjectPool.hpp"
+#include <new>
+#include <sys/mman.h>
+
+__thread ObjectPool::ThreadCache ObjectPool::_threadCaches[POOL_CACHED_MAX];
+unsigned int ObjectPool::_cachedPools = 0;
+
+ObjectPool::ObjectPool(const char* name, size_t objectSize, bool threadCached)
+    : _name(name), _free(NULL), _cursor(NULL), _limit(NULL), _hugePages(false), _cacheIndex(-1) {
+    // Every slot must hold a free-list link and keep objects aligned
+    if (objectSize < sizeof(FreeSlot))
+        objectSize = sizeof(FreeSlot);
+    _slotSize = (objectSize + POOL_ALIGNMENT - 1) & ~static_cast<size_t>(POOL_ALIGNMENT - 1);
+    _slabSize = POOL_SLAB_SIZE;
+    while (_slabSize < _slotSize)
+        _slabSize += POOL_SLAB_SIZE;
+
+    _stats.slotSize = _slotSize;
+    _stats.slabs = 0;
+    _stats.hugeSlabs = 0;
+    _stats.capacity = 0;
+    _stats.inUse = 0;
+    _stats.peak = 0;
+    _stats.allocations = 0;
+
+    if (threadCached) {
+        unsigned int index = __sync_fetch_and_add(&_cachedPools, 1);
+        if (index < POOL_CACHED_MAX)
+            _cacheIndex = index;
+    }
+}
+
+void ObjectPool::mapSlab() {
+    void* slab = MAP_FAILED;
+    if (_hugePages) {
+        slab = mmap(NULL, _slabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (slab != MAP_FAILED)
+            ++_stats.hugeSlabs;
+    }
+    if (slab == MAP_FAILED) {
+        // No reserved huge pages: fall back to transparent ones if asked for
+        slab = mmap(NULL, _slabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED)
+            throw std::bad_alloc();
+        if (_hugePages)
+            madvise(slab, _slabSize, MADV_HUGEPAGE);
+    }
+
+    _slabs.push_back(slab);
+    _cursor = static_cast<char*>(slab);
+    _limit = _cursor + (_slabSize / _slotSize) * _slotSize;
+    ++_stats.slabs;
+    _stats.capacity += _slabSize / _slotSize;
+}
+
+void* ObjectPool::allocate(size_t size) {
+    if (size > _slotSize)
+        throw std::bad_alloc();
+
+    if (_cacheIndex < 0) {
+        ScopedLock lock(_mutex);
+        return take();
+    }
+
+    ThreadCache& cache = _threadCaches[_cacheIndex];
+    if (!cache.head)
+        refill(cache);
+    FreeSlot* slot = cache.head;
+    cache.head = slot->next;
+    --cache.count;
+    return slot;
+}
+
+void ObjectPool::release(void* object) {
+    if (!object)
+        return;
+
+    if (_cacheIndex < 0) {
+        ScopedLock lock(_mutex);
+        give(object);
+        return;
+    }
+
+    ThreadCache& cache = _threadCaches[_cacheIndex];
+    FreeSlot* slot = static_cast<FreeSlot*>(object);
+    slot->next = cache.head;
+    cache.head = slot;
+    if (++cache.count >= POOL_CACHE_LIMIT)
+        drain(cache);
+}
+
+// Caller holds _mutex
+void* ObjectPool::take() {
+    void* object;
+    if (_free) {
+        object = _free;
+        _free = _free->next;
+    } else {
+        // Carve lazily so untouched slots never become resident
+        if (_cursor == _limit)
+            mapSlab();
+        object = _cursor;
+        _cursor += _slotSize;
+    }
+
+    ++_stats.allocations;
+    if (++_stats.inUse > _stats.peak)
+        _stats.peak = _stats.inUse;
+    return object;
+}
+
+// Caller holds _mutex
+void ObjectPool::give(void* object) {
+    FreeSlot* slot = static_cast<FreeSlot*>(object);
+    slot->next = _free;
+    _free = slot;
+    --_stats.inUse;
+}
+
+void ObjectPool::refill(ThreadCache& cache) {
+    ScopedLock lock(_mutex);
+    for (size_t i = 0; i < POOL_CACHE_BATCH; ++i) {
+        FreeSlot* slot = static_cast<FreeSlot*>(take());
+        slot->next = cache.head;
+        cache.head = slot;
+        ++cache.count;
+    }
+}
+
+// Keeps the rest, so a thread alternating around the limit does not
+// bounce every slot through the pool
+void ObjectPool::drain(ThreadCache& cache) {
+    ScopedLock lock(_mutex);
+    for (size_t i = 0; i < POOL_CACHE_BATCH; ++i) {
+        FreeSlot* slot = cache.head;
+        cache.head = slot->next;
+        give(slot);
+    }
+    cache.count -= POOL_CACHE_BATCH;
+}
+
+void ObjectPool::setHugePages(bool enabled) {
+    ScopedLock lock(_mutex);
+    _hugePages = enabled;
+}
+
+const char* ObjectPool::getName() const {
+    return _name;
+}
+
+ObjectPool::Stats ObjectPool::getStats() {
+    ScopedLock lock(_mutex);
+    return _stats;
+}
@@ -0,0 +1,131 @@
+#include "../include/OutputQueue.hpp"
+#include <errno.h>
+
+OutputQueue::OutputQueue() : _head(0), _count(0), _offset(0), _size(0), _overflowed(false) {}
+
+// Only the owning reactor writes _size, but the admin snapshot reads it
+// from another thread; relaxed accesses cost the same as plain ones
+static void storeSize(size_t& size, size_t value) {
+    __atomic_store_n(&size, value, __ATOMIC_RELAXED);
+}
+
+OutputQueue::~OutputQueue() {
+    clear();
+}
+
+// Getters
+bool OutputQueue::empty() const { return size() == 0; }
+size_t OutputQueue::size() const { return __atomic_load_n(&_size, __ATOMIC_RELAXED); }
+bool OutputQueue::isOverflowed() const { return _overflowed; }
+bool OutputQueue::isAtBoundary() const { return _offset == 0; }
+
+// Ring operations
+const SharedBuffer* OutputQueue::chunk(size_t index) const {
+    return _chunks[(_head + index) & (_chunks.size() - 1)];
+}
+
+void OutputQueue::grow() {
+    // Unwrap into a ring twice the size
+    std::vector<const SharedBuffer*> chunks(_chunks.empty() ? 16 : _chunks.size() * 2);
+    for (size_t i = 0; i < _count; ++i)
+        chunks[i] = chunk(i);
+    _chunks.swap(chunks);
+    _head = 0;
+}
+
+// Queue operations
+bool OutputQueue::push(const std::string& data) {
+    if (data.empty())
+        return !_overflowed;
+    SharedBuffer* buffer = SharedBuffer::create(data);
+    bool queued = push(buffer);
+    buffer->release();
+    return queued;
+}
+
+bool OutputQueue::push(const SharedBuffer* buffer) {
+    if (_overflowed)
+        return false;
+    if (!buffer || buffer->length() == 0)
+        return true;
+    if (_size + buffer->length() > MAX_SENDQ) {
+        _overflowed = true;
+        return false;
+    }
+    if (_count == _chunks.size())
+        grow();
+    buffer->retain();
+    _chunks[(_head + _count) & (_chunks.size() - 1)] = buffer;
+    ++_count;
+    storeSize(_size, _size + buffer->length());
+    return true;
+}
+
+void OutputQueue::clear() {
+    for (size_t i = 0; i < _count; ++i)
+        chunk(i)->release();
+    _head = 0;
+    _count = 0;
+    _offset = 0;
+    _overflowed = false;
+    storeSize(_size, 0);
+}
+
+int OutputQueue::prepare(struct iovec* iov, const SharedBuffer** chunks, int max) const {
+    int count = 0;
+    for (; static_cast<size_t>(count) < _count && count < max; ++count) {
+        const SharedBuffer* buffer = chunk(count);
+        size_t skip = (count == 0) ? _offset : 0;
+        iov[count].iov_base = const_cast<char*>(buffer->data()) + skip;
+        iov[count].iov_len = buffer->length() - skip;
+        if (chunks)
+            chunks[count] = buffer;
+    }
+    return count;
+}
+
+void OutputQueue::consume(size_t bytes) {
+    storeSize(_size, _size - bytes);
+    while (bytes > 0) {
+        const SharedBuffer* front = chunk(0);
+        size_t remaining = front->length() - _offset;
+        if (bytes < remaining) {
+            _offset += bytes;
+            return;
+        }
+        bytes -= remaining;
+        front->release();
+        _head = (_head + 1) & (_chunks.size() - 1);
+        --_count;
+        _offset = 0;
+    }
+}
+
+ssize_t OutputQueue::flush(int fd) {
+    struct iovec iov[OUTPUT_IOV_MAX];
+    ssize_t total = 0;
+
+    while (_count > 0) {
+        int count = prepare(iov, NULL, OUTPUT_IOV_MAX);
+        size_t batch = 0;
+        for (int i = 0; i < count; ++i)
+            batch += iov[i].iov_len;
+
+        ssize_t sent = writev(fd, iov, count);
+        if (sent == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        total += sent;
+        consume(sent);
+
+        // A short write means the socket buffer is full; skip the EAGAIN round trip
+        if ((size_t)sent < batch)
+            break;
+    }
+    return total;
+}
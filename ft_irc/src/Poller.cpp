@@ -0,0 +1,176 @@
+#include "../include/Poller.hpp"
+#include <stdexcept>
+#include <errno.h>
+#include <unistd.h>
+
+#define EPOLL_MAX_EVENTS 256
+
+Poller::~Poller() {}
+
+Poller* Poller::create(Backend backend) {
+    if (backend == BACKEND_EPOLL)
+        return new EpollPoller();
+    return new PollPoller();
+}
+
+bool Poller::parseBackend(const std::string& name, Backend& backend) {
+    if (name == "poll")
+        backend = BACKEND_POLL;
+    else if (name == "epoll")
+        backend = BACKEND_EPOLL;
+    else if (name == "io_uring")
+        backend = BACKEND_IO_URING;
+    else
+        return false;
+    return true;
+}
+
+// poll() backend
+
+PollPoller::PollPoller() {}
+
+PollPoller::~PollPoller() {}
+
+short PollPoller::toPollEvents(unsigned int events) {
+    short result = 0;
+    if (events & READ)
+        result |= POLLIN;
+    if (events & WRITE)
+        result |= POLLOUT;
+    return result;
+}
+
+void PollPoller::add(int fd, unsigned int events) {
+    if (fd >= (int)_index.size())
+        _index.resize(fd + 1, -1);
+    if (_index[fd] != -1) {
+        modify(fd, events);
+        return;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = toPollEvents(events);
+    pfd.revents = 0;
+    _index[fd] = _pollfds.size();
+    _pollfds.push_back(pfd);
+}
+
+void PollPoller::modify(int fd, unsigned int events) {
+    if (fd < 0 || fd >= (int)_index.size() || _index[fd] == -1)
+        return;
+    _pollfds[_index[fd]].events = toPollEvents(events);
+}
+
+void PollPoller::remove(int fd) {
+    if (fd < 0 || fd >= (int)_index.size() || _index[fd] == -1)
+        return;
+
+    // Swap-remove: move the last entry into the vacated slot
+    int position = _index[fd];
+    int last = _pollfds.size() - 1;
+    if (position != last) {
+        _pollfds[position] = _pollfds[last];
+        _index[_pollfds[position].fd] = position;
+    }
+    _pollfds.pop_back();
+    _index[fd] = -1;
+}
+
+int PollPoller::wait(std::vector<PollEvent>& ready, int timeout) {
+    ready.clear();
+    int count = poll(_pollfds.data(), _pollfds.size(), timeout);
+    if (count <= 0)
+        return count;
+
+    for (size_t i = 0; i < _pollfds.size() && (int)ready.size() < count; ++i) {
+        short revents = _pollfds[i].revents;
+        if (!revents)
+            continue;
+
+        PollEvent event;
+        event.fd = _pollfds[i].fd;
+        event.events = 0;
+        if (revents & POLLIN)
+            event.events |= READ;
+        if (revents & POLLOUT)
+            event.events |= WRITE;
+        if (revents & (POLLHUP | POLLERR | POLLNVAL))
+            event.events |= HANGUP;
+        ready.push_back(event);
+    }
+    return ready.size();
+}
+
+const char* PollPoller::getName() const { return "poll"; }
+
+// epoll backend
+
+EpollPoller::EpollPoller() : _events(EPOLL_MAX_EVENTS) {
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd == -1)
+        throw std::runtime_error("Failed to create epoll instance");
+}
+
+EpollPoller::~EpollPoller() {
+    if (_epollFd != -1)
+        close(_epollFd);
+}
+
+uint32_t EpollPoller::toEpollEvents(unsigned int events) {
+    uint32_t result = 0;
+    if (events & READ)
+        result |= EPOLLIN | EPOLLRDHUP;
+    if (events & WRITE)
+        result |= EPOLLOUT;
+    if (events & EDGE)
+        result |= EPOLLET;
+    return result;
+}
+
+void EpollPoller::add(int fd, unsigned int events) {
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = toEpollEvents(events);
+    ev.data.fd = fd;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        throw std::runtime_error("Failed to register fd with epoll");
+}
+
+void EpollPoller::modify(int fd, unsigned int events) {
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = toEpollEvents(events);
+    ev.data.fd = fd;
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void EpollPoller::remove(int fd) {
+    // The kernel drops the registration on close() anyway; ENOENT is harmless
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int EpollPoller::wait(std::vector<PollEvent>& ready, int timeout) {
+    ready.clear();
+    int count = epoll_wait(_epollFd, _events.data(), _events.size(), timeout);
+    if (count <= 0)
+        return count;
+
+    for (int i = 0; i < count; ++i) {
+        uint32_t revents = _events[i].events;
+        PollEvent event;
+        event.fd = _events[i].data.fd;
+        event.events = 0;
+        if (revents & EPOLLIN)
+            event.events |= READ;
+        if (revents & EPOLLOUT)
+            event.events |= WRITE;
+        if (revents & (EPOLLHUP | EPOLLERR | EPOLLRDHUP))
+            event.events |= HANGUP;
+        ready.push_back(event);
+    }
+    return count;
+}
+
+const char* EpollPoller::getName() const { return "epoll"; }
+int EpollPoller::getFd() const { return _epollFd; }
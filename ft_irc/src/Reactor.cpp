@@ -0,0 +1,471 @@
+#include "../include/Reactor.hpp"
+#include "../include/UringReactor.hpp"
+#include "../include/Server.hpp"
+#include "../include/Client.hpp"
+#include "../include/Utils.hpp"
+#include "../include/AdminEndpoint.hpp"
+#include <stdexcept>
+#include <errno.h>
+#include <stdint.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+
+// Reactor whose loop is running on the calling thread, if any
+static __thread Reactor* t_currentReactor = NULL;
+
+Reactor::Reactor(Server* server, int port, Poller* poller)
+    : _server(server), _listenSocket(-1), _wakeFd(-1), _poller(poller), _flushEarly(false), _admin(NULL),
+      _traceCountdown(0) {
+    setupListener(port);
+
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeFd == -1)
+        throw std::runtime_error("Failed to create eventfd");
+    if (_poller)
+        _poller->add(_wakeFd, Poller::READ);
+}
+
+Reactor* Reactor::create(Server* server, int port, Poller::Backend backend) {
+    if (backend == Poller::BACKEND_IO_URING) {
+        try {
+            return new UringReactor(server, port);
+        } catch (const std::exception& e) {
+            std::cerr << "io_uring unavailable (" << e.what() << "), falling back to epoll" << std::endl;
+            backend = Poller::BACKEND_EPOLL;
+        }
+    }
+    return new Reactor(server, port, Poller::create(backend));
+}
+
+Reactor::~Reactor() {
+    // Clean up clients
+    while (!_clients.empty()) {
+        Client* client = _clients.getClients().back();
+        _clients.remove(client->getFd());
+        close(client->getFd());
+        delete client;
+    }
+
+    // Drop undelivered messages
+    for (size_t i = 0; i < _inbox.size(); ++i)
+        _inbox[i].buffer->release();
+
+    if (_wakeFd != -1)
+        close(_wakeFd);
+    if (_listenSocket != -1)
+        close(_listenSocket);
+    delete _poller;
+}
+
+void Reactor::setupListener(int port) {
+    // Create socket
+    _listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listenSocket == -1)
+        throw std::runtime_error("Failed to create socket");
+
+    // Set socket options; SO_REUSEPORT lets every reactor bind its own listener
+    int opt = 1;
+    if (setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1
+        || setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1)
+        throw std::runtime_error("Failed to set socket options");
+
+    // Set non-blocking mode
+    Utils::setNonBlocking(_listenSocket);
+
+    // Bind socket
+    struct sockaddr_in serverAddr;
+    std::memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(port);
+
+    if (bind(_listenSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == -1)
+        throw std::runtime_error("Failed to bind socket");
+
+    // Listen for connections
+    if (listen(_listenSocket, SOMAXCONN) == -1)
+        throw std::runtime_error("Failed to listen on socket");
+
+    // Register the listener level-triggered so one accept per wakeup never loses a connection
+    if (_poller)
+        _poller->add(_listenSocket, Poller::READ);
+}
+
+// Getters
+const ConnectionTable& Reactor::getClients() const { return _clients; }
+Arena& Reactor::getArena() { return _arena; }
+Stats& Reactor::getStats() { return _stats; }
+const Stats& Reactor::getStats() const { return _stats; }
+const char* Reactor::getBackendName() const { return _poller->getName(); }
+int Reactor::getPort() const { return Utils::getPort(_listenSocket); }
+
+void Reactor::attachAdmin(AdminEndpoint* admin) {
+    _admin = admin;
+    if (_poller)
+        _poller->add(admin->getFd(), Poller::READ);
+}
+
+// Loop control
+void Reactor::run() {
+    std::vector<PollEvent> events;
+    bindToCurrentThread();
+
+    while (_server->isRunning()) {
+        int ready = _poller->wait(events, -1);
+        if (ready == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("Poll failed");
+        }
+
+        // Busy time only: the wait itself is not counted
+        uint64_t started = Stats::now();
+        uint64_t queued = _stats.get(Stats::BYTES_QUEUED);
+        for (int i = 0; i < ready; ++i) {
+            if (events[i].fd == _listenSocket) {
+                handleNewConnection();
+                continue;
+            }
+            if (events[i].fd == _wakeFd) {
+                handleWakeup();
+                continue;
+            }
+            if (_admin && events[i].fd == _admin->getFd()) {
+                _admin->poll();
+                continue;
+            }
+
+            // A handler earlier in this batch may already have dropped the client
+            Client* client = _clients.find(events[i].fd);
+            if (!client)
+                continue;
+
+            ConnectionTable::Handle handle = _clients.getHandle(events[i].fd);
+            if (events[i].events & (Poller::READ | Poller::HANGUP))
+                handleClientData(client);
+            if ((events[i].events & Poller::WRITE) && _clients.isValid(handle))
+                handleClientWrite(client);
+        }
+
+        // Replies produced during this iteration go out in one writev per client
+        flushPendingWrites();
+        _arena.reset();
+        uint64_t elapsed = Stats::now() - started;
+        _stats.recordIteration(elapsed);
+        _server->traceIteration(elapsed, ready, _stats.get(Stats::BYTES_QUEUED) - queued);
+    }
+}
+
+void* Reactor::threadMain(void* arg) {
+    Reactor* reactor = static_cast<Reactor*>(arg);
+    try {
+        reactor->run();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+    return NULL;
+}
+
+void Reactor::startThread() {
+    if (pthread_create(&_thread, NULL, &Reactor::threadMain, this) != 0)
+        throw std::runtime_error("Failed to start reactor thread");
+}
+
+void Reactor::joinThread() {
+    pthread_join(_thread, NULL);
+}
+
+void Reactor::bindToCurrentThread() {
+    t_currentReactor = this;
+}
+
+bool Reactor::isCurrentThread() const {
+    return t_currentReactor == this;
+}
+
+Reactor* Reactor::getCurrent() {
+    return t_currentReactor;
+}
+
+bool Reactor::sampleTrace(unsigned int interval) {
+    if (++_traceCountdown < interval)
+        return false;
+    _traceCountdown = 0;
+    return true;
+}
+
+// Event handlers
+void Reactor::handleNewConnection() {
+    int fds[ACCEPT_BATCH];
+    in_addr_t addresses[ACCEPT_BATCH];
+    int count = 0;
+
+    // Drain the backlog; the listener is level-triggered, so a burst larger
+    // than one batch is picked up on the next wakeup
+    while (count < ACCEPT_BATCH) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+        int clientFd = accept4(_listenSocket, (struct sockaddr*)&clientAddr, &clientLen,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (clientFd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                std::cerr << "Failed to accept connection" << std::endl;
+            break;
+        }
+        fds[count] = clientFd;
+        addresses[count] = clientAddr.sin_addr.s_addr;
+        ++count;
+    }
+    if (count == 0)
+        return;
+
+    // Admit the whole batch under one acquisition of the state lock
+    ScopedLock lock(_server->getStateLock());
+    for (int i = 0; i < count; ++i)
+        acceptClient(fds[i], addresses[i]);
+}
+
+bool Reactor::acceptClient(int fd, in_addr_t address) {
+    if (!_server->admitConnection(address)) {
+        // Rejected before a Client is allocated; the notice is best effort
+        static const char notice[] = "ERROR :Too many connections\r\n";
+        send(fd, notice, sizeof(notice) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+        close(fd);
+        _stats.add(Stats::REJECTS);
+        return false;
+    }
+    addClient(fd, address);
+    _stats.add(Stats::ACCEPTS);
+    return true;
+}
+
+void Reactor::handleClientData(Client* client) {
+    InputBuffer& input = client->getInput();
+    ConnectionTable::Handle handle = _clients.getHandle(client->getFd());
+
+    // Edge-triggered: keep reading until the socket reports EAGAIN
+    for (;;) {
+        size_t available;
+        char* buffer = input.reserve(available);
+        ssize_t bytesRead = recv(client->getFd(), buffer, available, 0);
+
+        if (bytesRead == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            if (errno == EINTR)
+                continue;
+        }
+        if (bytesRead <= 0) {
+            handleClientDisconnect(client);
+            return;
+        }
+
+        input.commit(bytesRead);
+        _stats.add(Stats::BYTES_IN, bytesRead);
+
+        bool alive = processCommands(client);
+        if (_flushEarly)
+            earlyFlush();
+        if (!alive || !_clients.isValid(handle))
+            return;
+    }
+}
+
+bool Reactor::processCommands(Client* client) {
+    InputBuffer& input = client->getInput();
+    StringView line;
+    InputBuffer::Status status = input.next(line);
+    if (status == InputBuffer::LINE_NONE)
+        return true;
+
+    // Each command takes the state lock in its own mode; only this thread
+    // adds to or removes from _clients, so the handle check needs no lock
+    ConnectionTable::Handle handle = _clients.getHandle(client->getFd());
+    for (; status != InputBuffer::LINE_NONE; status = input.next(line)) {
+        if (status == InputBuffer::LINE_TOO_LONG) {
+            client->sendMessage(Utils::formatMessage(SERVER_NAME, ERR_INPUTTOOLONG, ""));
+            continue;
+        }
+        _server->processCommand(client, line);
+
+        // QUIT releases the client from inside processCommand
+        if (!_clients.isValid(handle))
+            return false;
+    }
+    return true;
+}
+
+void Reactor::handleClientWrite(Client* client) {
+    ssize_t result = client->flushOutput();
+    if (result == -1) {
+        handleClientDisconnect(client);
+        return;
+    }
+    _stats.add(Stats::BYTES_OUT, result);
+
+    // Drop write interest once the queue has drained
+    if (!client->hasPendingOutput())
+        setWriteInterest(client, false);
+}
+
+void Reactor::handleClientDisconnect(Client* client) {
+    // Unregisters from the poller and closes the socket
+    ScopedLock lock(_server->getStateLock());
+    removeClient(client);
+}
+
+// The client stopped reading and its queue passed MAX_SENDQ; what is
+// queued is dropped unsent, and peers see why it left
+void Reactor::handleSendQueueExceeded(Client* client) {
+    // Mid-chunk the peer holds part of a line, so an ERROR would corrupt it
+    static const char error[] = "ERROR :SendQ exceeded\r\n";
+    if (client->getOutputQueue().isAtBoundary() && !isWriteInFlight(client))
+        send(client->getFd(), error, sizeof(error) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    ScopedLock lock(_server->getStateLock());
+    _server->broadcastToPeers(client, client->getSource() + " QUIT :SendQ exceeded\r\n");
+    removeClient(client);
+}
+
+void Reactor::handleWakeup() {
+    uint64_t count;
+    while (read(_wakeFd, &count, sizeof(count)) > 0)
+        ;
+
+    // The counter is drained before the swap, so a post racing with us re-arms it
+    {
+        ScopedLock lock(_inboxLock);
+        _delivering.swap(_inbox);
+    }
+
+    for (size_t i = 0; i < _delivering.size(); ++i) {
+        Client* client = _clients.find(_delivering[i].handle);
+        if (client)
+            client->deliver(_delivering[i].buffer);
+        _delivering[i].buffer->release();
+        if (_flushEarly)
+            earlyFlush();
+    }
+    _delivering.clear();
+}
+
+void Reactor::flushPendingWrites() {
+    int on = 1;
+    int off = 0;
+    bool corking = _server->isCorking();
+
+    _flushEarly = false;
+    for (size_t i = 0; i < _pendingWrites.size(); ++i) {
+        Client* client = _clients.find(_pendingWrites[i]);
+        if (client && client->getOutputQueue().isOverflowed()) {
+            handleSendQueueExceeded(client);
+            continue;
+        }
+        if (!client || client->isWriteWatched())
+            continue;
+
+        int fd = client->getFd();
+        if (corking)
+            setsockopt(fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+        ssize_t result = client->flushOutput();
+        if (corking)
+            setsockopt(fd, IPPROTO_TCP, TCP_CORK, &off, sizeof(off));
+
+        if (result == -1) {
+            handleClientDisconnect(client);
+            continue;
+        }
+        _stats.add(Stats::BYTES_OUT, result);
+        if (client->hasPendingOutput())
+            setWriteInterest(client, true);
+    }
+    _pendingWrites.clear();
+}
+
+void Reactor::setWriteInterest(Client* client, bool enabled) {
+    if (client->isWriteWatched() == enabled)
+        return;
+    client->setWriteWatched(enabled);
+    _poller->modify(client->getFd(), Poller::READ | Poller::EDGE | (enabled ? Poller::WRITE : 0));
+}
+
+// Client operations
+Client* Reactor::addClient(int fd, in_addr_t address) {
+    // Register for edge-triggered reads
+    if (_poller)
+        _poller->add(fd, Poller::READ | Poller::EDGE);
+
+    Client* client = new Client(fd, this, address);
+    _clients.insert(fd, client);
+    return client;
+}
+
+void Reactor::removeClient(Client* client) {
+    if (!client)
+        return;
+
+    // Remove from poll set
+    if (_poller)
+        _poller->remove(client->getFd());
+
+    // Remove from clients table
+    _clients.remove(client->getFd());
+    _server->detachClient(client);
+
+    // Close socket
+    close(client->getFd());
+    _stats.add(Stats::DISCONNECTS);
+
+    // Delete client
+    delete client;
+}
+
+// Output operations
+void Reactor::scheduleWrite(Client* client) {
+    _pendingWrites.push_back(_clients.getHandle(client->getFd()));
+}
+
+// A queue passed EARLY_FLUSH_BYTES in the middle of an iteration
+void Reactor::earlyFlush() {
+    flushPendingWrites();
+}
+
+// Readiness writes finish inside flushOutput(); only completions can be pending
+bool Reactor::isWriteInFlight(const Client* client) const {
+    (void)client;
+    return false;
+}
+
+void Reactor::requestEarlyFlush() {
+    _flushEarly = true;
+}
+
+void Reactor::wake() {
+    uint64_t one = 1;
+    if (write(_wakeFd, &one, sizeof(one)) == -1) {
+        // Already signalled; the reactor wakes regardless
+    }
+}
+
+void Reactor::post(Client* client, const SharedBuffer* buffer) {
+    Delivery delivery;
+    delivery.handle = _clients.getHandle(client->getFd());
+    delivery.buffer = buffer;
+    buffer->retain();
+
+    bool wake;
+    {
+        ScopedLock lock(_inboxLock);
+        wake = _inbox.empty();
+        _inbox.push_back(delivery);
+    }
+
+    if (wake) {
+        uint64_t one = 1;
+        if (write(_wakeFd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+            std::cerr << "Failed to wake reactor" << std::endl;
+    }
+}
@@ -1,241 +1,398 @@
-#include "../include/Server.hpp"
-#include "../include/Client.hpp"
-#include "../include/Channel.hpp"
-#include "../include/Command.hpp"
-#include "../include/Utils.hpp"
-#include "../include/Server.hpp"
-#include <iostream>
-#include <sstream>
-#include <cstring>
-#include <unistd.h>
-#include <fcntl.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <errno.h>
-#include <poll.h>
-
-
-Server::Server(int port, const std::string& password) : _password(password), _running(false) {
-    setupServer(port);
-}
-
-Server::~Server() {
-    // Clean up clients
-    for (ClientMap::iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        delete it->second;
-    }
-    _clients.clear();
-
-    // Clean up channels
-    for (ChannelMap::iterator it = _channels.begin(); it != _channels.end(); ++it) {
-        delete it->second;
-    }
-    _channels.clear();
-
-    // Close server socket
-    if (_serverSocket != -1)
-        close(_serverSocket);
-}
-
-void Server::setupServer(int port) {
-    // Create socket
-    _serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (_serverSocket == -1)
-        throw std::runtime_error("Failed to create socket");
-
-    // Set socket options
-    int opt = 1;
-    if (setsockopt(_serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1)
-        throw std::runtime_error("Failed to set socket options");
-
-    // Set non-blocking mode
-    Utils::setNonBlocking(_serverSocket);
-
-    // Bind socket
-    struct sockaddr_in serverAddr;
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
-
-    if (bind(_serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == -1)
-        throw std::runtime_error("Failed to bind socket");
-
-    // Listen for connections
-    if (listen(_serverSocket, SOMAXCONN) == -1)
-        throw std::runtime_error("Failed to listen on socket");
-
-    // Add server socket to poll set
-    struct pollfd pfd;
-    pfd.fd = _serverSocket;
-    pfd.events = POLLIN;
-    _pollfds.push_back(pfd);
-}
-
-void Server::start() {
-    _running = true;
-    std::cout << "Server started on port " << ntohs(((struct sockaddr_in*)&_serverSocket)->sin_port) << std::endl;
-}
-
-void Server::stop() {
-    _running = false;
-}
-
-void Server::run() {
-    while (_running) {
-        int ready = poll(_pollfds.data(), _pollfds.size(), -1);
-        if (ready == -1) {
-            if (errno == EINTR)
-                continue;
-            throw std::runtime_error("Poll failed");
-        }
-
-        for (size_t i = 0; i < _pollfds.size(); ++i) {
-            if (_pollfds[i].revents & POLLIN) {
-                if (_pollfds[i].fd == _serverSocket) {
-                    handleNewConnection();
-                } else {
-                    Client* client = _clients[_pollfds[i].fd];
-                    if (client)
-                        handleClientData(client);
-                }
-            }
-        }
-    }
-}
-
-void Server::handleNewConnection() {
-    struct sockaddr_in clientAddr;
-    socklen_t clientLen = sizeof(clientAddr);
-    int clientFd = accept(_serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
-
-    if (clientFd == -1) {
-        if (errno != EAGAIN && errno != EWOULDBLOCK)
-            std::cerr << "Failed to accept connection" << std::endl;
-        return;
-    }
-
-    // Set non-blocking mode
-    Utils::setNonBlocking(clientFd);
-
-    // Add to poll set
-    struct pollfd pfd;
-    pfd.fd = clientFd;
-    pfd.events = POLLIN;
-    _pollfds.push_back(pfd);
-
-    // Create new client
-    addClient(clientFd);
-}
-
-void Server::handleClientData(Client* client) {
-    char buffer[BUFFER_SIZE];
-    ssize_t bytesRead = recv(client->getFd(), buffer, BUFFER_SIZE - 1, 0);
-
-    if (bytesRead <= 0) {
-        if (bytesRead == 0 || (bytesRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))) {
-            handleClientDisconnect(client);
-        }
-        return;
-    }
-
-    buffer[bytesRead] = '\0';
-    client->appendToBuffer(buffer);
-
-    while (client->hasCompleteCommand()) {
-        std::string command = client->getNextCommand();
-        processCommand(client, command);
-    }
-}
-
-void Server::handleClientDisconnect(Client* client) {
-    // Remove from poll set
-    for (std::vector<pollfd>::iterator it = _pollfds.begin(); it != _pollfds.end(); ++it) {
-        if (it->fd == client->getFd()) {
-            _pollfds.erase(it);
-            break;
-        }
-    }
-
-    // Remove client
-    removeClient(client);
-}
-
-void Server::processCommand(Client* client, const std::string& command) {
-    Command cmd(command, client, this);
-    cmd.execute();
-}
-
-void Server::addClient(int fd) {
-    Client* client = new Client(fd);
-    _clients[fd] = client;
-}
-
-void Server::removeClient(Client* client) {
-    if (!client)
-        return;
-
-    // Remove from poll set
-    for (std::vector<pollfd>::iterator it = _pollfds.begin(); it != _pollfds.end(); ++it) {
-        if (it->fd == client->getFd()) {
-            _pollfds.erase(it);
-            break;
-        }
-    }
-
-    // Remove from clients map
-    _clients.erase(client->getFd());
-
-    // Close socket
-    close(client->getFd());
-
-    // Delete client
-    delete client;
-}
-
-Client* Server::getClient(const std::string& nickname) {
-    for (ClientMap::iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        if (it->second->getNickname() == nickname)
-            return it->second;
-    }
-    return NULL;
-}
-
-bool Server::isNicknameInUse(const std::string& nickname) const {
-    for (ClientMap::const_iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        if (it->second->getNickname() == nickname)
-            return true;
-    }
-    return false;
-}
-
-Channel* Server::getChannel(const std::string& name) {
-    ChannelMap::iterator it = _channels.find(name);
-    return it != _channels.end() ? it->second : NULL;
-}
-
-Channel* Server::createChannel(const std::string& name) {
-    Channel* channel = new Channel(name);
-    _channels[name] = channel;
-    return channel;
-}
-
-void Server::removeChannel(Channel* channel) {
-    if (!channel)
-        return;
-
-    _channels.erase(channel->getName());
-    delete channel;
-}
-
-bool Server::isChannelNameValid(const std::string& name) const {
-    return Utils::isValidChannelName(name);
-}
-
-void Server::broadcastToAll(const std::string& message, Client* sender) {
-    for (ClientMap::iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        if (it->second != sender) {
-            send(it->second->getFd(), message.c_str(), message.length(), 0);
-        }
-    }
-}
+#include "../include/Server.hpp"
+#include "../include/Client.hpp"
+#include "../include/Channel.hpp"
+#include "../include/Command.hpp"
+#include "../include/Utils.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdexcept>
+#include <ctime>
+
+
+Server::Server(int port, const std::string& password, Poller::Backend backend, size_t threads)
+    : _password(password), _startTime(time(NULL)), _admin(NULL), _corking(false), _clientCount(0), _maxClients(MAX_CLIENTS),
+      _maxClientsPerAddress(MAX_CLIENTS_PER_IP),
+      _broadcastEpoch(0), _traceBudget(TRACE_DEFAULT_BUDGET_US * 1000ULL), _traceSampling(0),
+      _running(false) {
+    setupServer(port, backend, threads);
+}
+
+Server::~Server() {
+    // Clean up clients
+    for (size_t i = 0; i < _reactors.size(); ++i) {
+        delete _reactors[i];
+    }
+    _reactors.clear();
+    delete _admin;
+
+    // Clean up channels
+    for (ChannelMap::iterator it = _channels.begin(); it != _channels.end(); ++it) {
+        delete it->second;
+    }
+    _channels.clear();
+}
+
+void Server::setupServer(int port, Poller::Backend backend, size_t threads) {
+    if (threads < 1 || threads > MAX_THREADS)
+        throw std::runtime_error("Invalid thread count");
+
+    // One reactor per thread, each with its own SO_REUSEPORT listener
+    for (size_t i = 0; i < threads; ++i)
+        _reactors.push_back(Reactor::create(this, port, backend));
+}
+
+void Server::start() {
+    _running = true;
+    _startTime = time(NULL);
+    std::cout << "Server started on port " << _reactors[0]->getPort()
+              << " (" << _reactors[0]->getBackendName() << " backend, "
+              << _reactors.size() << " reactor" << (_reactors.size() > 1 ? "s" : "") << ")" << std::endl;
+    if (_admin)
+        std::cout << "Metrics served on " << _admin->getName() << std::endl;
+}
+
+// Called from the signal handler: only sets the flag and wakes each
+// reactor, whose loop then sees it and returns
+void Server::stop() {
+    _running = false;
+    for (size_t i = 0; i < _reactors.size(); ++i)
+        _reactors[i]->wake();
+}
+
+void Server::run() {
+    for (size_t i = 1; i < _reactors.size(); ++i)
+        _reactors[i]->startThread();
+
+    // The calling thread drives the first reactor
+    _reactors[0]->run();
+
+    for (size_t i = 1; i < _reactors.size(); ++i)
+        _reactors[i]->joinThread();
+}
+
+bool Server::isRunning() const {
+    return _running;
+}
+
+void Server::setCorking(bool enabled) {
+    _corking = enabled;
+}
+
+bool Server::isCorking() const {
+    return _corking;
+}
+
+const std::string& Server::getPassword() const {
+    return _password;
+}
+
+time_t Server::getStartTime() const {
+    return _startTime;
+}
+
+void Server::setMaxClients(size_t limit) {
+    _maxClients = limit;
+}
+
+void Server::setMaxClientsPerAddress(unsigned int limit) {
+    _maxClientsPerAddress = limit;
+}
+
+void Server::setOperator(const std::string& name, const std::string& password) {
+    _operName = name;
+    _operPassword = password;
+}
+
+bool Server::checkOperator(const std::string& name, const std::string& password) const {
+    return hasOperator() && name == _operName && password == _operPassword;
+}
+
+bool Server::hasOperator() const {
+    return !_operPassword.empty();
+}
+
+void Server::collectStats(Stats& total) const {
+    for (size_t i = 0; i < _reactors.size(); ++i)
+        total.merge(_reactors[i]->getStats());
+}
+
+void Server::openAdmin(const std::string& endpoint) {
+    _admin = new AdminEndpoint(this, endpoint);
+    _reactors[0]->attachAdmin(_admin);
+}
+
+const std::vector<Reactor*>& Server::getReactors() const {
+    return _reactors;
+}
+
+SharedMutex& Server::getStateLock() {
+    return _stateLock;
+}
+
+// Verb and first parameter of a command that has run. QUIT has released
+// the client, and with it the input buffer its parameters point into
+static void describeCommand(const Command& cmd, TraceRecord& record) {
+    const Message& message = cmd.getMessage();
+    const Command::Spec* spec = cmd.getSpec();
+    if (spec)
+        TraceLog::copyField(record.verb, TRACE_VERB_MAX, spec->name, std::strlen(spec->name));
+    else
+        TraceLog::copyField(record.verb, TRACE_VERB_MAX, message.getCommand().data, message.getCommand().length);
+
+    // Credentials stay out of the log
+    bool secret = spec && (std::strcmp(spec->name, "PASS") == 0 || std::strcmp(spec->name, "OPER") == 0);
+    bool released = spec && std::strcmp(spec->name, "QUIT") == 0;
+    if (message.getParamCount() > 0 && !secret && !released)
+        TraceLog::copyField(record.target, TRACE_TARGET_MAX, message.getParam(0).data, message.getParam(0).length);
+    else
+        record.target[0] = '\0';
+}
+
+void Server::processCommand(Client* client, const StringView& line) {
+    // Timed on the client's own reactor; QUIT may free the client, not the reactor
+    Reactor* reactor = client->getReactor();
+    Stats& stats = reactor->getStats();
+    Command cmd(line, client, this);
+
+    // Commands that only read shared state run side by side on every reactor
+    ScopedLock lock(_stateLock, cmd.isShared());
+    uint64_t queued = stats.get(Stats::BYTES_QUEUED);
+    uint64_t started = Stats::now();
+
+    cmd.execute();
+
+    int slot = cmd.getSlot();
+    if (slot == -1)
+        return;
+    uint64_t elapsed = Stats::now() - started;
+    stats.recordCommand(slot, elapsed);
+
+    // Described only once it is known to be traced
+    bool sampled = _traceSampling != 0 && reactor->sampleTrace(_traceSampling);
+    bool slow = _traceBudget != 0 && elapsed >= _traceBudget;
+    if (!sampled && !slow)
+        return;
+
+    TraceRecord record;
+    describeCommand(cmd, record);
+
+    // A list such as "#a,#b" reports the first channel
+    Channel* channel = NULL;
+    if (record.target[0] == '#' || record.target[0] == '&') {
+        StringView name;
+        name.data = record.target;
+        name.length = std::strcspn(record.target, ",");
+        channel = findChannel(name);
+    }
+
+    record.kind = TraceRecord::COMMAND;
+    record.reason = slow ? TraceRecord::SLOW : TraceRecord::SAMPLED;
+    record.time = TraceLog::wallClock();
+    record.duration = elapsed;
+    record.bytes = stats.get(Stats::BYTES_QUEUED) - queued;
+    record.members = channel ? channel->size() : 0;
+    record.events = 0;
+    _trace.append(record);
+}
+
+void Server::setTraceBudget(uint64_t nanoseconds) {
+    _traceBudget = nanoseconds;
+}
+
+void Server::setTraceSampling(unsigned int interval) {
+    _traceSampling = interval;
+}
+
+uint64_t Server::getTraceBudget() const {
+    return _traceBudget;
+}
+
+unsigned int Server::getTraceSampling() const {
+    return _traceSampling;
+}
+
+const TraceLog& Server::getTraceLog() const {
+    return _trace;
+}
+
+// Called by each reactor for its own iterations, without the state lock
+void Server::traceIteration(uint64_t duration, size_t events, uint64_t bytes) {
+    if (_traceBudget == 0 || duration < _traceBudget)
+        return;
+
+    TraceRecord record;
+    record.kind = TraceRecord::ITERATION;
+    record.reason = TraceRecord::SLOW;
+    record.time = TraceLog::wallClock();
+    record.duration = duration;
+    record.bytes = bytes;
+    record.members = 0;
+    record.events = events;
+    record.verb[0] = '\0';
+    record.target[0] = '\0';
+    _trace.append(record);
+}
+
+bool Server::admitConnection(in_addr_t address) {
+    if (_clientCount >= _maxClients)
+        return false;
+
+    AddressCountMap::iterator it = _addressCounts.find(address);
+    if (it == _addressCounts.end()) {
+        _addressCounts.insert(std::make_pair(address, 1u));
+    } else {
+        if (it->second >= _maxClientsPerAddress)
+            return false;
+        ++it->second;
+    }
+    ++_clientCount;
+    return true;
+}
+
+void Server::releaseConnection(in_addr_t address) {
+    AddressCountMap::iterator it = _addressCounts.find(address);
+    if (it == _addressCounts.end())
+        return;
+
+    if (--it->second == 0)
+        _addressCounts.erase(it);
+    --_clientCount;
+}
+
+size_t Server::getClientCount() const {
+    return _clientCount;
+}
+
+void Server::removeClient(Client* client) {
+    if (client)
+        client->getReactor()->removeClient(client);
+}
+
+void Server::detachClient(Client* client) {
+    // Drops every trace of a departing client from the shared state
+    removeNickname(client);
+    while (!client->getChannels().empty())
+        partChannel(*client->getChannels().begin(), client);
+    releaseConnection(client->getAddress());
+}
+
+Client* Server::getClient(const std::string& nickname) {
+    return findClient(StringView::from(nickname));
+}
+
+Client* Server::findClient(const StringView& nickname) const {
+    std::pair<NicknameIndex::const_iterator, NicknameIndex::const_iterator> range =
+        _nicknames.equal_range(Utils::hashFolded(nickname));
+    for (NicknameIndex::const_iterator it = range.first; it != range.second; ++it) {
+        if (Utils::equalsFolded(nickname, StringView::from(it->second->getNickname())))
+            return it->second;
+    }
+    return NULL;
+}
+
+bool Server::isNicknameInUse(const std::string& nickname) const {
+    return findClient(StringView::from(nickname)) != NULL;
+}
+
+void Server::setNickname(Client* client, const std::string& nickname) {
+    // Re-keyed together with the rename, under the state lock
+    removeNickname(client);
+    client->setNickname(nickname);
+    if (!nickname.empty())
+        _nicknames.insert(std::make_pair(Utils::hashFolded(StringView::from(nickname)), client));
+
+    const std::set<Channel*>& channels = client->getChannels();
+    for (std::set<Channel*>::const_iterator it = channels.begin(); it != channels.end(); ++it)
+        (*it)->invalidateNames();
+}
+
+void Server::removeNickname(Client* client) {
+    if (client->getNickname().empty())
+        return;
+
+    std::pair<NicknameIndex::iterator, NicknameIndex::iterator> range =
+        _nicknames.equal_range(Utils::hashFolded(StringView::from(client->getNickname())));
+    for (NicknameIndex::iterator it = range.first; it != range.second; ++it) {
+        if (it->second == client) {
+            _nicknames.erase(it);
+            return;
+        }
+    }
+}
+
+const ChannelMap& Server::getChannels() const {
+    return _channels;
+}
+
+Channel* Server::getChannel(const std::string& name) {
+    return findChannel(StringView::from(name));
+}
+
+Channel* Server::findChannel(const StringView& name) const {
+    std::pair<ChannelMap::const_iterator, ChannelMap::const_iterator> range =
+        _channels.equal_range(Utils::hashFolded(name));
+    for (ChannelMap::const_iterator it = range.first; it != range.second; ++it) {
+        if (Utils::equalsFolded(name, StringView::from(it->second->getName())))
+            return it->second;
+    }
+    return NULL;
+}
+
+Channel* Server::createChannel(const std::string& name) {
+    Channel* channel = new Channel(name);
+    _channels.insert(std::make_pair(Utils::hashFolded(StringView::from(name)), channel));
+    return channel;
+}
+
+void Server::removeChannel(Channel* channel) {
+    if (!channel)
+        return;
+
+    std::pair<ChannelMap::iterator, ChannelMap::iterator> range =
+        _channels.equal_range(Utils::hashFolded(StringView::from(channel->getName())));
+    for (ChannelMap::iterator it = range.first; it != range.second; ++it) {
+        if (it->second == channel) {
+            _channels.erase(it);
+            break;
+        }
+    }
+    delete channel;
+}
+
+void Server::partChannel(Channel* channel, Client* client) {
+    channel->removeClient(client);
+
+    // The last member out frees the channel unless it is marked persistent (+P)
+    if (channel->empty() && !channel->isPersistent())
+        removeChannel(channel);
+}
+
+bool Server::isChannelNameValid(const std::string& name) const {
+    return Utils::isValidChannelName(name);
+}
+
+void Server::broadcastToPeers(Client* client, const std::string& message) {
+    // Every client reached is stamped with a fresh epoch, so a peer sharing
+    // several channels with the sender gets one copy; the sender is
+    // stamped first and never hears its own message
+    unsigned long epoch = ++_broadcastEpoch;
+    client->stampEpoch(epoch);
+
+    SharedBuffer* buffer = SharedBuffer::create(message);
+    const std::set<Channel*>& channels = client->getChannels();
+    for (std::set<Channel*>::const_iterator it = channels.begin(); it != channels.end(); ++it) {
+        const std::vector<Channel::Member>& members = (*it)->getMembers();
+        for (size_t i = 0; i < members.size(); ++i) {
+            if (members[i].client->stampEpoch(epoch))
+                members[i].client->sendMessage(buffer);
+        }
+    }
+    buffer->release();
+}
@@ -0,0 +1,64 @@
+#include "../include/SharedBuffer.hpp"
+#include <cstring>
+#include <new>
+
+SharedBuffer::SharedBuffer(size_t length, ObjectPool* pool) : _length(length), _refs(1), _pool(pool) {}
+
+SharedBuffer::~SharedBuffer() {}
+
+ObjectPool* SharedBuffer::poolFor(size_t size) {
+    // Slot sizes 128 to SHAREDBUFFER_POOLED_MAX, doubling; never destroyed
+    // since reactor threads may still release buffers during exit. Every
+    // send creates and every flush releases one, so each thread works from
+    // its own cache rather than the pool's lock
+    static ObjectPool* pools[] = {
+        new ObjectPool("buffer-128", 128, true),
+        new ObjectPool("buffer-256", 256, true),
+        new ObjectPool("buffer-512", 512, true),
+        new ObjectPool("buffer-1024", 1024, true),
+        new ObjectPool("buffer-2048", SHAREDBUFFER_POOLED_MAX, true)
+    };
+
+    size_t slot = 128;
+    for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); ++i, slot *= 2) {
+        if (size <= slot)
+            return pools[i];
+    }
+    return NULL;
+}
+
+SharedBuffer* SharedBuffer::create(const std::string& data) {
+    return create(StringView::from(data));
+}
+
+SharedBuffer* SharedBuffer::create(const StringView& data) {
+    size_t size = sizeof(SharedBuffer) + data.length;
+    ObjectPool* pool = poolFor(size);
+    void* memory = pool ? pool->allocate(size) : ::operator new(size);
+
+    SharedBuffer* buffer = new (memory) SharedBuffer(data.length, pool);
+    std::memcpy(const_cast<char*>(buffer->data()), data.data, data.length);
+    return buffer;
+}
+
+// Getters
+const char* SharedBuffer::data() const { return reinterpret_cast<const char*>(this + 1); }
+size_t SharedBuffer::length() const { return _length; }
+
+// Reference counting
+// Atomic: a buffer may be queued on clients owned by different reactors
+void SharedBuffer::retain() const {
+    __sync_add_and_fetch(&_refs, 1);
+}
+
+void SharedBuffer::release() const {
+    if (__sync_sub_and_fetch(&_refs, 1) == 0) {
+        ObjectPool* pool = _pool;
+        void* memory = const_cast<SharedBuffer*>(this);
+        this->~SharedBuffer();
+        if (pool)
+            pool->release(memory);
+        else
+            ::operator delete(memory);
+    }
+}
@@ -0,0 +1,130 @@
+#include "../include/Stats.hpp"
+#include <time.h>
+
+// Single-writer counters: a relaxed load and store compile to plain moves,
+// but keep a reader on another thread from seeing a torn value
+static uint64_t load(const uint64_t& counter) {
+    return __atomic_load_n(&counter, __ATOMIC_RELAXED);
+}
+
+static void store(uint64_t& counter, uint64_t value) {
+    __atomic_store_n(&counter, value, __ATOMIC_RELAXED);
+}
+
+static void bump(uint64_t& counter, uint64_t amount) {
+    store(counter, load(counter) + amount);
+}
+
+// Histogram
+Histogram::Histogram() : _count(0), _sum(0), _max(0) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        _buckets[i] = 0;
+}
+
+size_t Histogram::bucketOf(uint64_t value) {
+    const uint64_t subBuckets = 1 << HISTOGRAM_SUB_BITS;
+    if (value < subBuckets)
+        return value;
+    if (value > bucketLimit(HISTOGRAM_BUCKETS - 1))
+        return HISTOGRAM_BUCKETS - 1;
+
+    // The highest set bit picks the power of two, the next bits the sub-bucket
+    size_t magnitude = 63 - __builtin_clzll(value);
+    size_t sub = (value >> (magnitude - HISTOGRAM_SUB_BITS)) & (subBuckets - 1);
+    return (magnitude - HISTOGRAM_SUB_BITS + 1) * subBuckets + sub;
+}
+
+uint64_t Histogram::bucketLimit(size_t index) {
+    const uint64_t subBuckets = 1 << HISTOGRAM_SUB_BITS;
+    if (index < subBuckets)
+        return index;
+
+    size_t magnitude = index / subBuckets + HISTOGRAM_SUB_BITS - 1;
+    size_t shift = magnitude - HISTOGRAM_SUB_BITS;
+    return ((subBuckets + index % subBuckets + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    bump(_buckets[bucketOf(value)], 1);
+    bump(_count, 1);
+    bump(_sum, value);
+    if (value > load(_max))
+        store(_max, value);
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        _buckets[i] += load(other._buckets[i]);
+    _count += load(other._count);
+    _sum += load(other._sum);
+    uint64_t max = load(other._max);
+    if (max > _max)
+        _max = max;
+}
+
+uint64_t Histogram::getCount() const { return load(_count); }
+uint64_t Histogram::getSum() const { return load(_sum); }
+uint64_t Histogram::getMax() const { return load(_max); }
+
+uint64_t Histogram::percentile(double fraction) const {
+    uint64_t count = getCount();
+    if (count == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(fraction * count + 0.5);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += load(_buckets[i]);
+        if (seen >= rank) {
+            uint64_t limit = bucketLimit(i);
+            return limit < getMax() ? limit : getMax();
+        }
+    }
+    return getMax();
+}
+
+uint64_t Histogram::countBelow(uint64_t limit) const {
+    uint64_t count = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS && bucketLimit(i) < limit; ++i)
+        count += load(_buckets[i]);
+    return count;
+}
+
+// Stats
+Stats::Stats() {
+    for (size_t i = 0; i < COUNTER_COUNT; ++i)
+        _counters[i] = 0;
+}
+
+void Stats::add(Counter counter, uint64_t amount) {
+    bump(_counters[counter], amount);
+}
+
+void Stats::recordCommand(size_t slot, uint64_t nanoseconds) {
+    _commands[slot].record(nanoseconds);
+}
+
+void Stats::recordIteration(uint64_t nanoseconds) {
+    _iterations.record(nanoseconds);
+}
+
+void Stats::merge(const Stats& other) {
+    for (size_t i = 0; i < COUNTER_COUNT; ++i)
+        _counters[i] += load(other._counters[i]);
+    for (size_t i = 0; i < STATS_COMMAND_SLOTS; ++i)
+        _commands[i].merge(other._commands[i]);
+    _iterations.merge(other._iterations);
+}
+
+uint64_t Stats::get(Counter counter) const { return load(_counters[counter]); }
+const Histogram& Stats::getCommand(size_t slot) const { return _commands[slot]; }
+const Histogram& Stats::getIterations() const { return _iterations; }
+
+uint64_t Stats::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
@@ -0,0 +1,28 @@
+#include "../include/StringView.hpp"
+#include <cstring>
+
+StringView StringView::from(const std::string& str) {
+    StringView view;
+    view.data = str.data();
+    view.length = str.length();
+    return view;
+}
+
+StringView StringView::from(const char* str) {
+    StringView view;
+    view.data = str;
+    view.length = std::strlen(str);
+    return view;
+}
+
+bool StringView::empty() const {
+    return length == 0;
+}
+
+bool StringView::equals(const char* str) const {
+    return std::strlen(str) == length && std::memcmp(data, str, length) == 0;
+}
+
+std::string StringView::str() const {
+    return std::string(data, length);
+}
@@ -0,0 +1,41 @@
+#include "../include/TraceLog.hpp"
+#include <cstring>
+#include <ctime>
+
+TraceLog::TraceLog() : _written(0) {
+}
+
+void TraceLog::append(const TraceRecord& record) {
+    ScopedLock lock(_mutex);
+    _records[_written % TRACE_CAPACITY] = record;
+    ++_written;
+}
+
+uint64_t TraceLog::snapshot(std::vector<TraceRecord>& records) const {
+    ScopedLock lock(_mutex);
+    uint64_t first = _written > TRACE_CAPACITY ? _written - TRACE_CAPACITY : 0;
+    records.clear();
+    records.reserve(static_cast<size_t>(_written - first));
+    for (uint64_t i = first; i < _written; ++i)
+        records.push_back(_records[i % TRACE_CAPACITY]);
+    return _written;
+}
+
+uint64_t TraceLog::getWritten() const {
+    ScopedLock lock(_mutex);
+    return _written;
+}
+
+// Always NUL-terminated; excess input is cut
+void TraceLog::copyField(char* field, size_t size, const char* data, size_t length) {
+    if (length >= size)
+        length = size - 1;
+    std::memcpy(field, data, length);
+    field[length] = '\0';
+}
+
+uint64_t TraceLog::wallClock() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+}
@@ -0,0 +1,357 @@
+#include "../include/UringReactor.hpp"
+#include "../include/Server.hpp"
+#include "../include/Client.hpp"
+#include "../include/AdminEndpoint.hpp"
+#include <stdexcept>
+#include <errno.h>
+
+#define URING_ENTRIES 4096
+#define URING_BUFFER_GROUP 0
+#define URING_BUFFER_COUNT 1024 // Must be a power of two
+#define URING_BUFFER_SIZE 2048
+#define URING_OP_MASK 0x7ULL
+
+UringReactor::UringReactor(Server* server, int port)
+    : Reactor(server, port, NULL), _ring(URING_ENTRIES) {
+    _ring.setupBuffers(URING_BUFFER_GROUP, URING_BUFFER_COUNT, URING_BUFFER_SIZE);
+}
+
+UringReactor::~UringReactor() {
+    for (size_t i = 0; i < _spareSends.size(); ++i)
+        delete _spareSends[i];
+}
+
+const char* UringReactor::getBackendName() const { return "io_uring"; }
+
+uint64_t UringReactor::encode(Operation op, int fd, unsigned int generation) {
+    return ((uint64_t)generation << 32) | ((uint64_t)fd << 3) | op;
+}
+
+// Loop control
+void UringReactor::run() {
+    bindToCurrentThread();
+    armAccept();
+    armWakeup();
+    if (_admin)
+        armAdmin();
+
+    while (_server->isRunning()) {
+        // Sends queued by the previous batch ride along with the wait
+        armDeferredRecvs();
+        flushPendingWrites();
+
+        // Work the ring had no room for is retried without blocking
+        unsigned waitFor = _deferredRecvs.empty() && _pendingWrites.empty() ? 1 : 0;
+        if (_ring.submitAndWait(waitFor) == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("io_uring_enter failed");
+        }
+
+        // Busy time only: the wait itself is not counted
+        uint64_t started = Stats::now();
+        uint64_t queued = _stats.get(Stats::BYTES_QUEUED);
+        struct io_uring_cqe* cqe;
+        while ((cqe = _ring.peekCompletion()) != NULL) {
+            _completions.push_back(*cqe);
+            _ring.advanceCompletion();
+        }
+        // earlyFlush() may append while the batch is handled
+        for (size_t i = 0; i < _completions.size(); ++i) {
+            struct io_uring_cqe completion = _completions[i];
+            handleCompletion(completion);
+        }
+        size_t completions = _completions.size();
+        _completions.clear();
+        _arena.reset();
+        uint64_t elapsed = Stats::now() - started;
+        _stats.recordIteration(elapsed);
+        _server->traceIteration(elapsed, completions, _stats.get(Stats::BYTES_QUEUED) - queued);
+    }
+}
+
+// Request submission
+void UringReactor::armAccept() {
+    struct io_uring_sqe* sqe = _ring.getSqe();
+    if (!sqe)
+        throw std::runtime_error("io_uring submission queue full");
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = _listenSocket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = encode(OP_ACCEPT, _listenSocket, 0);
+}
+
+void UringReactor::armWakeup() {
+    struct io_uring_sqe* sqe = _ring.getSqe();
+    if (!sqe)
+        throw std::runtime_error("io_uring submission queue full");
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = _wakeFd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = encode(OP_WAKEUP, _wakeFd, 0);
+}
+
+// One-shot, re-armed after each poll(): the endpoint's fd stays readable
+// while a scrape is in progress, and a fresh poll reports that at once
+void UringReactor::armAdmin() {
+    struct io_uring_sqe* sqe = _ring.getSqe();
+    if (!sqe)
+        throw std::runtime_error("io_uring submission queue full");
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = _admin->getFd();
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = encode(OP_ADMIN, _admin->getFd(), 0);
+}
+
+void UringReactor::armRecv(int fd) {
+    struct io_uring_sqe* sqe = _ring.getSqe();
+    if (!sqe) {
+        // Without a recv the connection would never be read again
+        _deferredRecvs.push_back(_clients.getHandle(fd));
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = _ring.getBufferGroup();
+    sqe->user_data = encode(OP_RECV, fd, _clients.getHandle(fd).generation);
+}
+
+// Runs before the wait, when the previous submit has emptied the ring
+void UringReactor::armDeferredRecvs() {
+    if (_deferredRecvs.empty())
+        return;
+
+    std::vector<ConnectionTable::Handle> deferred;
+    deferred.swap(_deferredRecvs);
+    for (size_t i = 0; i < deferred.size(); ++i) {
+        if (_clients.find(deferred[i]))
+            armRecv(deferred[i].fd);
+    }
+}
+
+void UringReactor::flushPendingWrites() {
+    _flushEarly = false;
+    for (size_t i = 0; i < _pendingWrites.size(); ++i) {
+        Client* client = _clients.find(_pendingWrites[i]);
+        if (client && client->getOutputQueue().isOverflowed()) {
+            handleSendQueueExceeded(client);
+            continue;
+        }
+        if (!client || client->isWriteWatched() || !client->hasPendingOutput())
+            continue;
+
+        // No room: this client and the rest stay queued for the next
+        // iteration, since nothing else would schedule them again
+        struct io_uring_sqe* sqe = _ring.getSqe();
+        if (!sqe) {
+            _pendingWrites.erase(_pendingWrites.begin(), _pendingWrites.begin() + i);
+            return;
+        }
+
+        PendingSend* send = acquireSend();
+        send->handle = _pendingWrites[i];
+        send->count = client->getOutputQueue().prepare(send->iov, send->chunks, OUTPUT_IOV_MAX);
+        for (int j = 0; j < send->count; ++j)
+            send->chunks[j]->retain();
+
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = client->getFd();
+        sqe->addr = reinterpret_cast<uint64_t>(send->iov);
+        sqe->len = send->count;
+        sqe->user_data = reinterpret_cast<uint64_t>(send) | OP_SEND;
+
+        // One writev in flight per client keeps the queue offsets consistent
+        client->setWriteWatched(true);
+    }
+    _pendingWrites.clear();
+}
+
+// A send is in flight for as long as the client is write-watched; its
+// completion has yet to say how much of the front chunk went out
+bool UringReactor::isWriteInFlight(const Client* client) const {
+    return client->isWriteWatched();
+}
+
+// Sends only leave with a submit, and their completions would queue behind
+// the rest of the batch's input. Submitting now and handling finished sends
+// ahead of that input keeps a busy queue draining within one batch; a send
+// completion only consumes the front of its queue, so the reordering is safe
+void UringReactor::earlyFlush() {
+    flushPendingWrites();
+    if (_ring.submitAndWait(0) == -1)
+        return;
+
+    struct io_uring_cqe* cqe;
+    while ((cqe = _ring.peekCompletion()) != NULL) {
+        struct io_uring_cqe completion = *cqe;
+        _ring.advanceCompletion();
+        if ((completion.user_data & URING_OP_MASK) == OP_SEND)
+            handleSend(completion);
+        else
+            _completions.push_back(completion);
+    }
+}
+
+// Completion handlers
+void UringReactor::handleCompletion(const struct io_uring_cqe& cqe) {
+    switch (cqe.user_data & URING_OP_MASK) {
+        case OP_ACCEPT:
+            handleAccept(cqe);
+            break;
+        case OP_RECV:
+            handleRecv(cqe);
+            break;
+        case OP_SEND:
+            handleSend(cqe);
+            break;
+        case OP_WAKEUP:
+            handleWakeup();
+            if (!(cqe.flags & IORING_CQE_F_MORE))
+                armWakeup();
+            break;
+        case OP_ADMIN:
+            _admin->poll();
+            armAdmin();
+            break;
+        default:
+            break;
+    }
+}
+
+void UringReactor::handleAccept(const struct io_uring_cqe& cqe) {
+    if (cqe.res >= 0) {
+        // Multishot accept does not report the peer address
+        struct sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+        in_addr_t address = INADDR_ANY;
+        if (getpeername(cqe.res, (struct sockaddr*)&clientAddr, &clientLen) == 0)
+            address = clientAddr.sin_addr.s_addr;
+
+        ScopedLock lock(_server->getStateLock());
+        acceptClient(cqe.res, address);
+    } else if (cqe.res != -EAGAIN && cqe.res != -ECANCELED) {
+        std::cerr << "Failed to accept connection" << std::endl;
+    }
+
+    if (!(cqe.flags & IORING_CQE_F_MORE))
+        armAccept();
+}
+
+void UringReactor::handleRecv(const struct io_uring_cqe& cqe) {
+    ConnectionTable::Handle handle;
+    handle.fd = (cqe.user_data >> 3) & 0x1FFFFFFF;
+    handle.generation = cqe.user_data >> 32;
+
+    bool hasBuffer = cqe.flags & IORING_CQE_F_BUFFER;
+    unsigned short bufferId = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+
+    // Completions for a connection that has since been closed only return their buffer
+    Client* client = _clients.find(handle);
+    if (!client) {
+        if (hasBuffer)
+            _ring.recycleBuffer(bufferId);
+        return;
+    }
+
+    if (cqe.res > 0) {
+        _stats.add(Stats::BYTES_IN, cqe.res);
+
+        // Frame as we copy; a ring buffer larger than the free input space goes in pieces
+        const char* data = _ring.getBuffer(bufferId);
+        size_t remaining = cqe.res;
+        bool alive = true;
+        while (remaining > 0 && alive) {
+            size_t taken = client->getInput().append(data, remaining);
+            data += taken;
+            remaining -= taken;
+            alive = processCommands(client);
+            if (_flushEarly) {
+                earlyFlush();
+                alive = alive && _clients.find(handle);
+            }
+        }
+        _ring.recycleBuffer(bufferId);
+
+        if (!alive)
+            return;
+        if (!(cqe.flags & IORING_CQE_F_MORE))
+            armRecv(handle.fd);
+        return;
+    }
+
+    if (hasBuffer)
+        _ring.recycleBuffer(bufferId);
+
+    // Buffer ring ran dry: the multishot recv stopped, start a new one
+    if (cqe.res == -ENOBUFS) {
+        armRecv(handle.fd);
+        return;
+    }
+    handleClientDisconnect(client);
+}
+
+void UringReactor::handleSend(const struct io_uring_cqe& cqe) {
+    PendingSend* send = reinterpret_cast<PendingSend*>(cqe.user_data & ~URING_OP_MASK);
+
+    Client* client = _clients.find(send->handle);
+    if (client) {
+        client->setWriteWatched(false);
+        if (cqe.res >= 0) {
+            _stats.add(Stats::BYTES_OUT, cqe.res);
+            client->getOutputQueue().consume(cqe.res);
+            if (client->hasPendingOutput())
+                scheduleWrite(client);
+        } else if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+            scheduleWrite(client);
+        } else {
+            handleClientDisconnect(client);
+        }
+    }
+
+    for (int i = 0; i < send->count; ++i)
+        send->chunks[i]->release();
+    recycleSend(send);
+}
+
+// Finished sends are kept for reuse, so steady output allocates nothing
+UringReactor::PendingSend* UringReactor::acquireSend() {
+    if (_spareSends.empty())
+        return new PendingSend;
+    PendingSend* send = _spareSends.back();
+    _spareSends.pop_back();
+    return send;
+}
+
+void UringReactor::recycleSend(PendingSend* send) {
+    _spareSends.push_back(send);
+}
+
+// Client operations
+Client* UringReactor::addClient(int fd, in_addr_t address) {
+    Client* client = Reactor::addClient(fd, address);
+    armRecv(fd);
+    return client;
+}
+
+void UringReactor::removeClient(Client* client) {
+    if (!client)
+        return;
+
+    // Stop the multishot recv; its remaining completions fail the generation check
+    ConnectionTable::Handle handle = _clients.getHandle(client->getFd());
+    struct io_uring_sqe* sqe = _ring.getSqe();
+    if (sqe) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = encode(OP_RECV, handle.fd, handle.generation);
+        sqe->user_data = OP_CANCEL;
+    } else {
+        // No room for the cancel; shutting the socket down ends the recv instead
+        shutdown(handle.fd, SHUT_RDWR);
+    }
+
+    Reactor::removeClient(client);
+}
@@ -1,55 +1,147 @@
-#include "../include/IRC.hpp"
-#include "../include/Server.hpp"
-#include "../include/Utils.hpp"
-#include <iostream>
-#include <cstdlib>
-#include <signal.h>
-
-Server* g_server = NULL;
-
-void signalHandler(int signal) {
-    if (signal == SIGINT || signal == SIGTERM) {
-        std::cout << "\nShutting down server..." << std::endl;
-        if (g_server) {
-            g_server->stop();
-        }
-        exit(0);
-    }
-}
-
-void setupSignalHandlers() {
-    struct sigaction sa;
-    sa.sa_handler = signalHandler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    sigaction(SIGINT, &sa, NULL);
-    sigaction(SIGTERM, &sa, NULL);
-}
-
-int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <port> <password>" << std::endl;
-        return 1;
-    }
-
-    int port = std::atoi(argv[1]);
-    if (port <= 0 || port > 65535) {
-        std::cerr << "Invalid port number" << std::endl;
-        return 1;
-    }
-
-    setupSignalHandlers();
-
-    try {
-        g_server = new Server(port, argv[2]);
-        g_server->start();
-        g_server->run();
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        delete g_server;
-        return 1;
-    }
-
-    delete g_server;
-    return 0;
+#include "../include/IRC.hpp"
+#include "../include/Server.hpp"
+#include "../include/Utils.hpp"
+#include "../include/Client.hpp"
+#include "../include/Channel.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <signal.h>
+
+Server* g_server = NULL;
+
+static void printPoolStats(ObjectPool& pool) {
+    ObjectPool::Stats stats = pool.getStats();
+    std::cout << pool.getName() << " pool: " << stats.inUse << "/" << stats.capacity << " slots in use"
+              << " (peak " << stats.peak << ", " << stats.allocations << " allocations, "
+              << stats.slabs << " slabs of " << stats.slotSize << "-byte slots, "
+              << stats.hugeSlabs << " on huge pages)" << std::endl;
+}
+
+// Only async-signal-safe work here; main reports and cleans up once
+// Server::run() returns
+void signalHandler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        if (g_server)
+            g_server->stop();
+        else
+            _exit(0);
+    }
+}
+
+void setupSignalHandlers() {
+    struct sigaction sa;
+    sa.sa_handler = signalHandler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    // Writes to a closed peer must fail with EPIPE instead of killing the server
+    signal(SIGPIPE, SIG_IGN);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <port> <password> [--backend poll|epoll|io_uring] [--cork] [--threads N] [--max-clients N] [--max-per-ip N] [--huge-pages] [--oper NAME PASSWORD] [--admin PATH|PORT] [--trace-budget USEC] [--trace-sample N]" << std::endl;
+        return 1;
+    }
+
+    int port = std::atoi(argv[1]);
+    if (port <= 0 || port > 65535) {
+        std::cerr << "Invalid port number" << std::endl;
+        return 1;
+    }
+
+    Poller::Backend backend = Poller::BACKEND_EPOLL;
+    bool corking = false;
+    int threads = 1;
+    int maxClients = MAX_CLIENTS;
+    int maxPerAddress = MAX_CLIENTS_PER_IP;
+    std::string operName;
+    std::string operPassword;
+    std::string adminEndpoint;
+    long traceBudget = TRACE_DEFAULT_BUDGET_US;
+    int traceSampling = 0;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--backend" && i + 1 < argc) {
+            if (!Poller::parseBackend(argv[++i], backend)) {
+                std::cerr << "Unknown backend: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (option == "--cork") {
+            corking = true;
+        } else if (option == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+            if (threads < 1 || threads > MAX_THREADS) {
+                std::cerr << "Invalid thread count" << std::endl;
+                return 1;
+            }
+        } else if (option == "--max-clients" && i + 1 < argc) {
+            maxClients = std::atoi(argv[++i]);
+            if (maxClients < 1) {
+                std::cerr << "Invalid client limit" << std::endl;
+                return 1;
+            }
+        } else if (option == "--max-per-ip" && i + 1 < argc) {
+            maxPerAddress = std::atoi(argv[++i]);
+            if (maxPerAddress < 1) {
+                std::cerr << "Invalid per-IP connection limit" << std::endl;
+                return 1;
+            }
+        } else if (option == "--huge-pages") {
+            Client::getPool().setHugePages(true);
+            Channel::getPool().setHugePages(true);
+        } else if (option == "--oper" && i + 2 < argc) {
+            operName = argv[++i];
+            operPassword = argv[++i];
+        } else if (option == "--admin" && i + 1 < argc) {
+            adminEndpoint = argv[++i];
+        } else if (option == "--trace-budget" && i + 1 < argc) {
+            traceBudget = std::atol(argv[++i]);
+            if (traceBudget < 0) {
+                std::cerr << "Invalid trace budget" << std::endl;
+                return 1;
+            }
+        } else if (option == "--trace-sample" && i + 1 < argc) {
+            traceSampling = std::atoi(argv[++i]);
+            if (traceSampling < 0) {
+                std::cerr << "Invalid trace sampling interval" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+
+    setupSignalHandlers();
+
+    try {
+        g_server = new Server(port, argv[2], backend, threads);
+        g_server->setCorking(corking);
+        g_server->setMaxClients(maxClients);
+        g_server->setMaxClientsPerAddress(maxPerAddress);
+        g_server->setOperator(operName, operPassword);
+        g_server->setTraceBudget(static_cast<uint64_t>(traceBudget) * 1000);
+        g_server->setTraceSampling(traceSampling);
+        if (!adminEndpoint.empty())
+            g_server->openAdmin(adminEndpoint);
+        g_server->start();
+        g_server->run();
+
+        // A second signal during cleanup ends the process at once
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        delete g_server;
+        return 1;
+    }
+
+    std::cout << "\nShutting down server..." << std::endl;
+    printPoolStats(Client::getPool());
+    printPoolStats(Channel::getPool());
+    delete g_server;
+    return 0;
 } 
\ No newline at end of file